@@ -10,6 +10,8 @@
 #include <chrono>
 #include <Eigen/Dense>
 
+#include "rrt_planning/utils/Stats.h"
+
 //#define DEBUG_CONF
 //#define PRINT_CONF
 //#define VIS_CONF
@@ -20,8 +22,8 @@ namespace rrt_planning
 class AbstractPlanner : public nav_core::BaseGlobalPlanner
 {
 public:
-    AbstractPlanner(){}
-    AbstractPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros){}
+    AbstractPlanner() : stats() {}
+    AbstractPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros) : stats() {}
 
     virtual void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) = 0;
     virtual bool makePlan(const geometry_msgs::PoseStamped& start,
@@ -37,6 +39,9 @@ public:
     std::vector<Eigen::VectorXd> getPath();
     std::vector<Eigen::VectorXd> getFirstPath();
 
+    //Counters and timers of the last query
+    const Stats& getStats() const;
+
 
     virtual ~AbstractPlanner();
 
@@ -60,6 +65,8 @@ protected:
     std::vector<Eigen::VectorXd> first_path;
     std::vector<Eigen::VectorXd> final_path;
 
+    Stats stats;
+
 };
 
 }
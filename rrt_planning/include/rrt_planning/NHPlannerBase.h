@@ -0,0 +1,183 @@
+#ifndef INCLUDE_NHPLANNERBASE_H_
+#define INCLUDE_NHPLANNERBASE_H_
+
+#include <ros/ros.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <costmap_2d/costmap_2d.h>
+#include <nav_core/base_global_planner.h>
+#include <geometry_msgs/PoseStamped.h>
+
+#include <Eigen/Dense>
+
+#include "rrt_planning/distance/Distance.h"
+#include "rrt_planning/extenders/ExtenderFactory.h"
+#include "rrt_planning/visualization/Visualizer.h"
+#include "rrt_planning/sampling/position/SamplingPositionFactory.h"
+#include "rrt_planning/sampling/angle/SamplingAngleFactory.h"
+#include "rrt_planning/nh/CornerIndex.h"
+#include "rrt_planning/nh/OpenList.h"
+#include "rrt_planning/nh/Policies.h"
+#include "rrt_planning/nh/StateTable.h"
+#include "rrt_planning/nh/TriangleIndex.h"
+#include "rrt_planning/map/SGMap.h"
+#include "rrt_planning/map/MapFactory.h"
+#include "rrt_planning/map/VisibilityGraph.h"
+#include "rrt_planning/AbstractPlanner.h"
+#include "rrt_planning/utils/Arena.h"
+#include "rrt_planning/utils/ThreadPool.h"
+
+
+namespace rrt_planning
+{
+
+/*
+ * NH search core, shared by the NH planners. SteerPolicy extends the tree
+ * towards a sample with an extender, Metric is the planar distance of the
+ * heuristics. Both are resolved at compile time, the instances are in
+ * NHPlannerBase.cpp.
+ */
+template<class SteerPolicy, class Metric>
+class NHPlannerBase : public AbstractPlanner
+{
+public:
+    NHPlannerBase();
+    NHPlannerBase(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+    NHPlannerBase(std::string name, costmap_2d::Costmap2DROS* costmap_ros, std::chrono::duration<double> t);
+    NHPlannerBase(std::string name, Map& map, std::chrono::duration<double> t);
+
+    void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) override;
+    void initialize(std::string name, Map& map);
+    bool makePlan(const geometry_msgs::PoseStamped& start,
+                  const geometry_msgs::PoseStamped& goal,
+                  std::vector<geometry_msgs::PoseStamped>& plan) override;
+
+    virtual ~NHPlannerBase();
+
+private:
+    void initialize(ros::NodeHandle& private_nh);
+    bool search(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                std::vector<geometry_msgs::PoseStamped>& plan);
+    void release();
+    void prepareContext(const Eigen::Vector3d& xGoal);
+    void resetContext();
+    Node* reusePlan(Node* start_node);
+    void recordPlan(Node* node, std::vector<geometry_msgs::PoseStamped>& plan,
+                    const ros::Time& stamp, bool first);
+    void reach(Node* current, const std::vector<Eigen::VectorXd>& targets, int n);
+    Node* createNode(Node* current, int rollout);
+    bool isReached(const Eigen::Vector3d& x0, const Eigen::Vector3d& xTarget);
+
+    Eigen::Vector3d convertPose(const geometry_msgs::PoseStamped& pose);
+
+    void publishPlan(std::vector<Eigen::VectorXd>& path, std::vector<geometry_msgs::PoseStamped>& plan,
+                     const ros::Time& stamp);
+
+    void addOpen(Node* node, const Action& action);
+    void addSubgoal(Node* node, const Action& action);
+    double heuristic(const Eigen::Vector3d& x);
+    double estimate(Node* node, const Action& action);
+    void findAction(Node* node, const Action& action, std::vector<Action>& actions,
+                    std::vector<Triangle>& triangles);
+    void retrievePath(Node* node, std::vector<Eigen::VectorXd>& path);
+
+    void sampleCorner(const Eigen::Vector3d& corner, bool cw);
+    double sampleAngle(double theta);
+
+    void addGlobal(const Eigen::Vector3d& node, const Eigen::Vector3d& action, const Eigen::Vector3d& parent);
+    bool insideGlobal(const Eigen::Vector3d& p, bool subgoal);
+    Triangle createTriangle(const Action& a, const Eigen::VectorXd& n);
+
+private:
+    //Result of a steer rollout towards a sample
+    struct Rollout
+    {
+        bool valid;
+        Eigen::VectorXd xNew;
+        std::vector<Eigen::VectorXd> parents;
+        double cost;
+    };
+
+    //Node of the last plan, kept by the persistent context
+    struct Waypoint
+    {
+        Eigen::Vector3d state;
+        double cost;
+        std::vector<Eigen::Vector3d> mp;
+    };
+
+private:
+    Map* rosmap;
+    SGMap* map;
+    VisibilityGraph* visibility;
+    Distance* l2thetadis;
+    SteerPolicy steer;
+    Metric metric;
+    AngleMetric angle;
+
+    Action target;
+    OpenList open;
+    StateTable<Node*> reached;
+    StateTable<std::vector<Eigen::VectorXd> > corner_samples;
+    CornerIndex index;
+    TriangleIndex global_closed;
+
+    //Persistent context: the corners and their samples found for a goal, and
+    //the last plan, survive the query until the goal or the map changes
+    bool persistent;
+    bool contextValid;
+    Eigen::Vector3d contextGoal;
+    std::vector<Eigen::Vector3d> corners;
+    std::vector<Waypoint> solution;
+
+    //Nodes and actions of the current query, recycled by the next one.
+    //Actions refer to their parent by index in the action pool
+    ObjectPool<Node> nodes;
+    std::vector<Action> actionPool;
+
+    //The rollouts of the samples of a corner run on the pool, each worker
+    //with its own extender
+    ThreadPool* pool;
+    std::vector<ExtenderFactory*> workerExtenders;
+    std::vector<Rollout> rollouts;
+
+    //Buffers of the search loop, kept across expansions and queries. The
+    //states are copied in the VectorXd ones to be passed to the map
+    Eigen::VectorXd x0;
+    Eigen::VectorXd xGoal;
+    Eigen::VectorXd xCurr;
+    Eigen::VectorXd xNode;
+    Eigen::VectorXd xAction;
+    Eigen::VectorXd xParent;
+    std::vector<Eigen::VectorXd> samples;
+    std::vector<Eigen::VectorXd> collision;
+    std::vector<Eigen::VectorXd> parentCollision;
+    std::vector<Action> newActions;
+    std::vector<Triangle> triangles;
+
+    double deltaX;
+    double deltaTheta;
+    int count;
+    int k;
+    int k_ancestors;
+    double visibility_tolerance;
+
+    //Anytime mode: the heuristic is inflated by epsilon, lowered by
+    //epsilon_step after each plan down to 1, reusing the search
+    bool anytime;
+    double epsilon;
+    double epsilon_start;
+    double epsilon_step;
+
+    MapFactory mapFactory;
+    ExtenderFactory extenderFactory;
+    Visualizer visualizer;
+    SamplingAngleFactory angleFactory;
+    SamplingPositionFactory positionFactory;
+
+};
+
+}
+
+
+
+#endif /* INCLUDE_NHPLANNERBASE_H_ */
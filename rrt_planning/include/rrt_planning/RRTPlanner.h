@@ -34,6 +34,7 @@
 
 #include "rrt_planning/distance/Distance.h"
 #include "rrt_planning/extenders/ExtenderFactory.h"
+#include "rrt_planning/map/MapFactory.h"
 #include "rrt_planning/visualization/Visualizer.h"
 #include "rrt_planning/AbstractPlanner.h"
 
@@ -47,8 +48,10 @@ public:
     RRTPlanner();
     RRTPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
     RRTPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros, std::chrono::duration<double> t);
+    RRTPlanner(std::string name, Map& map, std::chrono::duration<double> t);
 
     void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) override;
+    void initialize(std::string name, Map& map);
     bool makePlan(const geometry_msgs::PoseStamped& start,
                   const geometry_msgs::PoseStamped& goal,
                   std::vector<geometry_msgs::PoseStamped>& plan) override;
@@ -56,6 +59,7 @@ public:
     virtual ~RRTPlanner();
 
 private:
+    void initialize(ros::NodeHandle& private_nh);
     bool newState(const Eigen::VectorXd& xRand,
                   const Eigen::VectorXd& xNear,
                   Eigen::VectorXd& xNew,
@@ -76,6 +80,8 @@ private:
     double deltaX;
     double greedy;
 
+    MapFactory mapFactory;
+
     ExtenderFactory extenderFactory;
 
     Visualizer visualizer;
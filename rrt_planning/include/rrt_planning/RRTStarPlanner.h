@@ -8,6 +8,7 @@
 
 #include "rrt_planning/distance/Distance.h"
 #include "rrt_planning/extenders/ExtenderFactory.h"
+#include "rrt_planning/map/MapFactory.h"
 #include "rrt_planning/visualization/Visualizer.h"
 #include "rrt_planning/AbstractPlanner.h"
 
@@ -21,8 +22,10 @@ public:
     RRTStarPlanner();
     RRTStarPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
     RRTStarPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros, std::chrono::duration<double> t);
+    RRTStarPlanner(std::string name, Map& map, std::chrono::duration<double> t);
 
     void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) override;
+    void initialize(std::string name, Map& map);
     bool makePlan(const geometry_msgs::PoseStamped& start,
                   const geometry_msgs::PoseStamped& goal,
                   std::vector<geometry_msgs::PoseStamped>& plan) override;
@@ -30,6 +33,7 @@ public:
     virtual ~RRTStarPlanner();
 
 private:
+    void initialize(ros::NodeHandle& private_nh);
     bool newState(const Eigen::VectorXd& xRand,
                   const Eigen::VectorXd& xNear,
                   Eigen::VectorXd& xNew,
@@ -58,6 +62,8 @@ private:
     int dimension;
     int knn;
 
+    MapFactory mapFactory;
+
     ExtenderFactory extenderFactory;
 
     Visualizer visualizer;
@@ -31,7 +31,7 @@
 #include <geometry_msgs/PoseStamped.h>
 #include <Eigen/Dense>
 
-#include "rrt_planning/map/ROSMap.h"
+#include "rrt_planning/map/MapFactory.h"
 #include "rrt_planning/grid/Grid.h"
 #include "rrt_planning/theta_star/PriorityQueue.h"
 #include "rrt_planning/visualization/Visualizer.h"
@@ -73,8 +73,9 @@ private:
 
     static const Cell S_NULL;
 
-    ROSMap* map;
+    Map* map;
     Grid* grid;
+    MapFactory mapFactory;
 
     Cell s_start;
     Cell s_goal;
@@ -34,6 +34,7 @@
 
 #include "rrt_planning/distance/Distance.h"
 #include "rrt_planning/extenders/ExtenderFactory.h"
+#include "rrt_planning/map/MapFactory.h"
 #include "rrt_planning/visualization/Visualizer.h"
 
 #include "rrt_planning/ThetaStarPlanner.h"
@@ -82,6 +83,8 @@ private:
 
     ThetaStarPlanner* thetaStarPlanner;
 
+    MapFactory mapFactory;
+
     ExtenderFactory extenderFactory;
 
     Visualizer visualizer;
@@ -10,7 +10,7 @@
 
 #include "dynamicvoronoi.h"
 
-#include "rrt_planning/map/ROSMap.h"
+#include "rrt_planning/map/MapFactory.h"
 #include "rrt_planning/grid/Grid.h"
 #include "rrt_planning/theta_star/PriorityQueue.h"
 #include "rrt_planning/visualization/Visualizer.h"
@@ -48,10 +48,13 @@ private:
     static const Cell S_NULL;
 	double discretization;
 
-    ROSMap* map;
+    Map* map;
     Grid* grid;
+    MapFactory mapFactory;
 
 	DynamicVoronoi voronoi_;
+	bool** gridMap;
+	std::vector<bool> occupied;
 
     Cell s_start;
     Cell s_goal;
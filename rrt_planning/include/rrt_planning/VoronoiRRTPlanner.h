@@ -12,6 +12,7 @@
 
 #include "rrt_planning/distance/Distance.h"
 #include "rrt_planning/extenders/ExtenderFactory.h"
+#include "rrt_planning/map/MapFactory.h"
 #include "rrt_planning/visualization/Visualizer.h"
 
 #include <voronoi_planner/planner_core.h>
@@ -61,6 +62,8 @@ class VoronoiRRTPlanner : public AbstractPlanner
         voronoi_planner::VoronoiPlanner* voronoiPlanner;
         rrt_planning::Voronoi* voronoi;
 
+        MapFactory mapFactory;
+
         ExtenderFactory extenderFactory;
 
         Visualizer visualizer;
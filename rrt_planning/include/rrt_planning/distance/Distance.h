@@ -35,8 +35,8 @@ namespace rrt_planning
 class Distance
 {
 public:
-    virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) = 0;
-    virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, double length) = 0;
+    virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2) = 0;
+    virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2, double length) = 0;
     virtual ~Distance()
     {
 
@@ -46,12 +46,12 @@ public:
 class L2Distance : public Distance
 {
 public:
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2) override
     {
         return (x1.head(2)-x2.head(2)).norm();
     }
 
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, double length) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2, double length) override
     {
         return (x1.head(2)-x2.head(2)).norm();
     }
@@ -63,7 +63,7 @@ class L2ThetaDistance : public Distance
 public:
     L2ThetaDistance(double wt = 1.0, double wr = 1.0) : wt(wt), wr(wr){}
 
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2) override
     {
         double poseDistance = (x1.head(2)-x2.head(2)).norm();
         double angleDistance = 1.0 - std::cos(x1(2) - x2(2));
@@ -71,7 +71,7 @@ public:
         return wt*poseDistance + wr*angleDistance;
     }
 
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, double length) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2, double length) override
     {
         double poseDistance = (x1.head(2)-x2.head(2)).norm();
         double angleDistance = 1.0 - std::cos(x1(2) - x2(2));
@@ -90,7 +90,7 @@ class WeightedL2ThetaDistance: public Distance
 public:
     WeightedL2ThetaDistance(double wt = 1.0, double wr_a = 0.5, double wr_p = 0.5): wt(wt), wr_a(wr_a), wr_p(wr_p) {}
 
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2) override
     {
         double poseDistance = (x1.head(2)-x2.head(2)).squaredNorm();
         double difference = angles::shortest_angular_distance(x1(2), x2(2));
@@ -99,7 +99,7 @@ public:
         return wt*poseDistance + wr_p*angleDistance;
     }
 
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, double length)
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2, double length)
     {
         double rho = (x1.head(2)-x2.head(2)).squaredNorm();
         double alpha = atan2(x2(1) - x1(1), x2(0) - x1(0));
@@ -128,12 +128,12 @@ private:
 class ThetaDistance : public Distance
 {
 public:
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, double length) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2, double length) override
     {
         return length;
     }
 
-    inline virtual double operator()(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) override
+    inline virtual double operator()(const Eigen::Ref<const Eigen::VectorXd>& x1, const Eigen::Ref<const Eigen::VectorXd>& x2) override
     {
         double angle = x1(2) - x2(2);
         if(fabs(angle) > M_PI){
@@ -33,13 +33,13 @@ namespace rrt_planning
 {
 struct CmpReached
 {
-  bool operator()(const Eigen::VectorXd a, const Eigen::VectorXd b) const
+  bool operator()(const Eigen::VectorXd& a, const Eigen::VectorXd& b) const
   {
       return ((a(0) < b(0)) ||(a(0) == b(0) && a(1) < b(1)) ||
                (a(0) == b(0) && a(1) == b(1) && a(2) < b(2)));
   }
 
-  bool operator()(const Eigen::Vector2d a, const Eigen::Vector2d b) const
+  bool operator()(const Eigen::Vector2d& a, const Eigen::Vector2d& b) const
   {
       return ((a(0) < b(0)) ||(a(0) == b(0) && a(1) < b(1)));
   }
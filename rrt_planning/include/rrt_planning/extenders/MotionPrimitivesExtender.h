@@ -24,6 +24,7 @@
 #include "rrt_planning/extenders/Extender.h"
 #include "rrt_planning/kinematics_models/KinematicModel.h"
 #include "rrt_planning/kinematics_models/controllers/ConstantController.h"
+#include "rrt_planning/map/SnapshotMap.h"
 
 
 namespace rrt_planning
@@ -48,9 +49,33 @@ public:
 private:
     void generateMotionPrimitives();
     void generateMotionPrimitive(const Eigen::VectorXd& u, const Eigen::VectorXd& du, unsigned int index);
+    void generateSweptCells();
+    bool isSweptFree(const Eigen::VectorXd& x0, unsigned int primitive);
+
+private:
+    //Cells covered by a primitive, relative to the start cell, for one heading bucket
+    struct SweptCells
+    {
+        std::vector<std::pair<int, int>> offsets;
+        int minX;
+        int maxX;
+        int minY;
+        int maxY;
+    };
 
 private:
     std::vector<Eigen::VectorXd> motionPrimitives;
+    std::vector<Eigen::VectorXd> candidates;
+    Eigen::Matrix2Xd candidatesXY;
+    Eigen::Matrix<bool, Eigen::Dynamic, 1> candidatesFree;
+
+    SnapshotMap* snapshot;
+    std::vector<Eigen::Matrix2Xd> trajectories;
+    std::vector<SweptCells> sweptCells;
+    bool swept;
+    int headingBuckets;
+    double sweptStep;
+    double sweptResolution;
     KinematicModel& model;
     ConstantController& controller;
 
@@ -0,0 +1,88 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_CLEARANCEFIELD_H_
+#define INCLUDE_RRT_PLANNING_MAP_CLEARANCEFIELD_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dynamicvoronoi.h"
+#include "rrt_planning/map/TiledLayer.h"
+
+namespace rrt_planning
+{
+
+class MapVersion;
+
+/*
+ * Euclidean distance to the nearest non free cell, for every cell of a
+ * map version. Computed by the DynamicVoronoi brushfire on a grid padded by
+ * an occupied ring, so that leaving the map counts as a collision. After the
+ * first computation, updates only occupy and clear the cells that changed,
+ * optionally looking only inside the window that the map reports as changed.
+ */
+class ClearanceField
+{
+public:
+    ClearanceField();
+
+    void update(const MapVersion& map);
+    void update(const MapVersion& map, int minX, int minY, int maxX, int maxY);
+
+    //Lower bound of the distance from any point of the cell to an obstacle.
+    //A point may be half a cell diagonal away from its cell center,
+    //as may the closest point of the obstacle cell
+    inline double getClearanceCell(int mx, int my) const
+    {
+        double distance = voronoi->getDistance(mx + 1, my + 1);
+        return std::max(0.0, (distance - M_SQRT2) * resolution);
+    }
+
+    //Clearance of every cell
+    void fill(TiledLayer<float>& clearance) const;
+
+    //Clearance of the cells that an update of the window may have changed
+    void fill(TiledLayer<float>& clearance, int minX, int minY, int maxX, int maxY) const;
+
+    ~ClearanceField();
+
+private:
+    void initialize(const MapVersion& map);
+    void applyChanges(const MapVersion& map, int minX, int minY, int maxX, int maxY);
+    double fillCell(TiledLayer<float>& clearance, int mx, int my) const;
+
+private:
+    DynamicVoronoi* voronoi;
+
+    int sizeX;
+    int sizeY;
+    double resolution;
+
+    std::vector<bool> occupied;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_CLEARANCEFIELD_H_ */
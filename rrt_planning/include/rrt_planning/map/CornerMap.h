@@ -0,0 +1,92 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_CORNERMAP_H_
+#define INCLUDE_RRT_PLANNING_MAP_CORNERMAP_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "rrt_planning/map/TiledLayer.h"
+
+namespace rrt_planning
+{
+
+class MapVersion;
+
+/*
+ * Convex corners of the obstacles of a map version. A blocked cell next to a
+ * free one is a corner if less than threshold of a ring of radius around it
+ * is blocked, and it faces the mean direction of the free part of the ring.
+ * Corners are stored as a tiled bit plane with the layout of the free bits,
+ * so that the corners around a point are found scanning a few words per row.
+ * All the coordinates and distances are in cells.
+ */
+class CornerMap
+{
+public:
+    //Direction of the corners that face every direction
+    static const unsigned char OMNI = 255;
+
+public:
+    CornerMap();
+
+    void update(const MapVersion& map, double radius, double threshold);
+    void update(const MapVersion& map, int minX, int minY, int maxX, int maxY);
+
+    //True if a corner within radius faces the point, or no cell within radius is blocked
+    bool isCorner(const MapVersion& map, double x, double y, double radius) const;
+
+    inline bool isCornerCell(int mx, int my) const
+    {
+        return (bits(mx >> 6, my) >> (mx & 63)) & 1;
+    }
+
+    inline bool isEmpty() const
+    {
+        return bits.empty();
+    }
+
+private:
+    void classify(const MapVersion& map, int minX, int minY, int maxX, int maxY);
+    bool isBoundary(const MapVersion& map, int mx, int my) const;
+    bool isConvex(const MapVersion& map, int mx, int my, unsigned char& direction) const;
+    bool isBlocked(const MapVersion& map, double x, double y) const;
+
+private:
+    int sizeX;
+    int sizeY;
+    double radius;
+    double threshold;
+
+    //Offsets of the ring samples from the cell center
+    std::vector<double> ringX;
+    std::vector<double> ringY;
+
+    TiledLayer<uint64_t, 0, 6> bits;
+    TiledLayer<unsigned char> directions;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_CORNERMAP_H_ */
@@ -24,8 +24,11 @@
 #ifndef INCLUDE_RRT_PLANNING_MAP_MAP_H_
 #define INCLUDE_RRT_PLANNING_MAP_MAP_H_
 
+#include <algorithm>
 #include <Eigen/Dense>
 #include "rrt_planning/map/Bounds.h"
+#include "rrt_planning/map/GridGeometry.h"
+#include "rrt_planning/utils/Stats.h"
 
 namespace rrt_planning
 {
@@ -40,6 +43,116 @@ public:
     virtual bool insideBound(const Eigen::VectorXd& p) = 0;
     virtual Eigen::VectorXd getOutsidePoint() = 0;
 
+    //Refresh the map data before a planning query
+    virtual void update()
+    {
+    }
+
+    //World bounds of the cells changed by the last update, false if unknown
+    virtual bool getChangedBounds(Bounds& changed)
+    {
+        return false;
+    }
+
+    //True if getChangedBounds can know the changes of the updates
+    virtual bool reportsChanges()
+    {
+        return false;
+    }
+
+    //Free test of every column of points, written in out
+    virtual void isFreeBatch(const Eigen::Matrix2Xd& points, bool* out)
+    {
+        Stats::count(Stats::MAP_BATCH_POINTS, points.cols());
+
+        Eigen::VectorXd p(2);
+        for(int i = 0; i < points.cols(); i++)
+        {
+            p = points.col(i);
+            out[i] = isFree(p);
+        }
+    }
+
+    //Cell grid the map is sampled on, false if the map is not backed by one
+    virtual bool getGrid(GridGeometry& grid)
+    {
+        return false;
+    }
+
+    //Free test of cell (mx, my) of the grid, the cells outside of it are not free
+    virtual bool isFreeGridCell(int mx, int my)
+    {
+        return false;
+    }
+
+    //Distance from p to the nearest obstacle, 0 when unknown
+    virtual double getClearance(const Eigen::VectorXd& p)
+    {
+        return 0;
+    }
+
+    //Entry point of the first non free cell crossed by the segment a-b, false if there is none.
+    //Maps without a grid are traversed on a virtual grid of the given resolution
+    bool firstCollisionAlongRay(const Eigen::Vector2d& a, const Eigen::Vector2d& b, Eigen::Vector2d& collision,
+                                double resolution = 0.05);
+
+    //Swept disc check, true only if the segment a-b is certainly free. The disc of
+    //clearance around a point is free, so the segment is walked from disc to disc
+    bool isSweptFree(const Eigen::VectorXd& a, const Eigen::VectorXd& b)
+    {
+        Eigen::VectorXd p = a;
+        Eigen::Vector2d direction = b.head<2>() - a.head<2>();
+        double length = direction.norm();
+
+        if(length > 0)
+            direction /= length;
+
+        while(true)
+        {
+            double clearance = getClearance(p);
+
+            if(length < clearance)
+                return true;
+
+            if(clearance <= 0)
+                return false;
+
+            p.head<2>() += clearance * direction;
+            length -= clearance;
+        }
+    }
+
+    //Number of samples p + i*delta, with i in [1, n], known to be free without checking them
+    virtual int freeSteps(const Eigen::Vector2d& p, const Eigen::Vector2d& delta)
+    {
+        Eigen::VectorXd x = p;
+        double steps = getClearance(x) / delta.norm();
+        return (steps >= 1) ? static_cast<int>(std::min(steps, 1e6)) : 0;
+    }
+
+    //True if the map keeps a precomputed corner layer
+    virtual bool hasCorners()
+    {
+        return false;
+    }
+
+    //Corner test of p against the corner layer, see CornerMap
+    virtual bool isCorner(const Eigen::VectorXd& p, double radius)
+    {
+        return false;
+    }
+
+    //True only if every point within radius of the segment a-b is certainly free
+    virtual bool isCorridorFree(const Eigen::VectorXd& a, const Eigen::VectorXd& b, double radius)
+    {
+        return false;
+    }
+
+    //Fraction of the segment a-b, from a, whose corridor is certainly free, above 1 if all of it is
+    virtual double getFreeFraction(const Eigen::VectorXd& a, const Eigen::VectorXd& b, double radius)
+    {
+        return 0;
+    }
 
     inline Bounds getBounds()
     {
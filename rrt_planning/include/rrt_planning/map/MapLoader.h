@@ -0,0 +1,104 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_MAPLOADER_H_
+#define INCLUDE_RRT_PLANNING_MAP_MAPLOADER_H_
+
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "rrt_planning/map/SnapshotMap.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Builds a SnapshotMap without a running costmap. The map descriptor and
+ * its image are interpreted as map_server does in trinary mode, then the
+ * costs are translated and inflated as the static and inflation layers of
+ * costmap_2d would do with the given costmap parameters.
+ */
+class MapLoader
+{
+public:
+    MapLoader();
+
+    //Costmap parameters, later files override earlier ones
+    void loadCostmapParams(const std::string& filename);
+    void loadMap(const std::string& filename);
+
+    //The caller takes ownership of the map
+    SnapshotMap* createMap();
+
+    inline int getSizeX() const
+    {
+        return sizeX;
+    }
+
+    inline int getSizeY() const
+    {
+        return sizeY;
+    }
+
+    inline const std::vector<unsigned char>& getCosts() const
+    {
+        return costs;
+    }
+
+    ~MapLoader();
+
+private:
+    void readParams(const YAML::Node& node);
+    void readImage(const std::string& filename, std::vector<unsigned char>& pixels, int& channels);
+    void readPNG(const std::string& filename, std::vector<unsigned char>& pixels, int& channels);
+    void readPGM(const std::string& filename, std::vector<unsigned char>& pixels, int& channels);
+    void readBMP(const std::string& filename, std::vector<unsigned char>& pixels, int& channels);
+    void inflate();
+    double computeInscribedRadius();
+    unsigned char computeCost(double distance);
+
+private:
+    //Map descriptor
+    int sizeX;
+    int sizeY;
+    double resolution;
+    double originX;
+    double originY;
+    std::vector<unsigned char> costs;
+
+    //Costmap parameters
+    bool trackUnknown;
+    int lethalThreshold;
+    double inflationRadius;
+    double costScalingFactor;
+    double robotRadius;
+    double footprintPadding;
+    std::vector<Eigen::Vector2d> footprint;
+    double inscribedRadius;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_MAPLOADER_H_ */
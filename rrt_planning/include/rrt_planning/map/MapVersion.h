@@ -0,0 +1,194 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_MAPVERSION_H_
+#define INCLUDE_RRT_PLANNING_MAP_MAPVERSION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "rrt_planning/map/CornerMap.h"
+#include "rrt_planning/map/OccupancyPyramid.h"
+#include "rrt_planning/map/TiledLayer.h"
+
+namespace rrt_planning
+{
+
+/*
+ * One immutable version of a SnapshotMap: the costs, their bit planes and
+ * the derived layers. Versions are built by the writer of the SnapshotMap
+ * and never modified once published, so that any number of readers can use
+ * them without locking while newer versions are built.
+ * The layers are tiled, so a version built from the previous one shares the
+ * tiles of every layer outside the changed cells.
+ * The bit planes store the cells x of row y in the word (x / 64, y).
+ */
+class MapVersion
+{
+public:
+    //Cells changed by the version number, in cells
+    struct Window
+    {
+        unsigned int number;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    //Changed windows kept in each version
+    static const unsigned int HISTORY = 16;
+
+    //One word of 64 cells per row of each tile
+    typedef TiledLayer<uint64_t, 0, 6> BitLayer;
+
+public:
+    MapVersion();
+
+    inline bool worldToMap(double wx, double wy, int& mx, int& my) const
+    {
+        //Same rounding as Costmap2D::worldToMap
+        double fx = (wx - originX) / resolution;
+        double fy = (wy - originY) / resolution;
+
+        if(!(fx >= 0 && fy >= 0 && fx < sizeX && fy < sizeY))
+            return false;
+
+        mx = static_cast<int>(fx);
+        my = static_cast<int>(fy);
+
+        return true;
+    }
+
+    inline bool isFreeCell(int mx, int my) const
+    {
+        return (freeBits(mx >> 6, my) >> (mx & 63)) & 1;
+    }
+
+    inline bool isVoronoiFreeCell(int mx, int my) const
+    {
+        return (voronoiBits(mx >> 6, my) >> (mx & 63)) & 1;
+    }
+
+    inline unsigned char getCostCell(int mx, int my) const
+    {
+        return costs(mx, my);
+    }
+
+    inline double getClearanceCell(int mx, int my) const
+    {
+        return clearance(mx, my);
+    }
+
+    inline bool hasClearance() const
+    {
+        return !clearance.empty();
+    }
+
+    inline const OccupancyPyramid& getPyramid() const
+    {
+        return pyramid;
+    }
+
+    inline const CornerMap& getCorners() const
+    {
+        return corners;
+    }
+
+    inline bool hasCorners() const
+    {
+        return !corners.isEmpty();
+    }
+
+    inline int getSizeX() const
+    {
+        return sizeX;
+    }
+
+    inline int getSizeY() const
+    {
+        return sizeY;
+    }
+
+    inline double getResolution() const
+    {
+        return resolution;
+    }
+
+    inline double getInvResolution() const
+    {
+        return invResolution;
+    }
+
+    inline double getOriginX() const
+    {
+        return originX;
+    }
+
+    inline double getOriginY() const
+    {
+        return originY;
+    }
+
+    inline unsigned int getNumber() const
+    {
+        return number;
+    }
+
+    //Union of the windows changed after the version since, false if unknown
+    bool getChangedSince(unsigned int since, int& minX, int& minY, int& maxX, int& maxY) const;
+
+private:
+    void resize(int sizeX, int sizeY);
+    void computeBits();
+    void computeBits(int minX, int minY, int maxX, int maxY);
+    void addHistory(int minX, int minY, int maxX, int maxY);
+
+private:
+    int sizeX;
+    int sizeY;
+    double resolution;
+    double invResolution;
+    double originX;
+    double originY;
+
+    //Version number and the last version rebuilt from scratch
+    unsigned int number;
+    unsigned int fullNumber;
+    std::vector<Window> history;
+
+    TiledLayer<unsigned char> costs;
+    BitLayer freeBits;
+    BitLayer voronoiBits;
+
+    OccupancyPyramid pyramid;
+    TiledLayer<float> clearance;
+    CornerMap corners;
+
+    friend class SnapshotMap;
+    friend class CornerMap;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_MAPVERSION_H_ */
@@ -0,0 +1,152 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_MAPPEDMAP_H_
+#define INCLUDE_RRT_PLANNING_MAP_MAPPEDMAP_H_
+
+#include "rrt_planning/map/Map.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace rrt_planning
+{
+
+/*
+ * Read only map backed by a memory mapped binary file. Costs, free bits
+ * and the optional clearance are stored in 64x64 cell tiles, so that every
+ * query touches a few contiguous pages. The pages are shared by all the
+ * processes mapping the same file, and open() shares a single instance
+ * among the planners of a process.
+ */
+class MappedMap : public Map
+{
+public:
+    static const int TILE_BITS = 6;
+    static const int TILE_SIZE = 1 << TILE_BITS;
+    static const int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t tileSize;
+        int32_t sizeX;
+        int32_t sizeY;
+        int32_t tilesX;
+        int32_t tilesY;
+        double resolution;
+        double originX;
+        double originY;
+        uint64_t costOffset;
+        uint64_t freeOffset;
+        uint64_t clearanceOffset;
+    };
+
+public:
+    explicit MappedMap(const std::string& filename);
+
+    //Instance shared by every caller while someone holds it
+    static std::shared_ptr<MappedMap> open(const std::string& filename);
+
+    //Writes a row major cost grid, the clearance in meters may be null
+    static void write(const std::string& filename, int sizeX, int sizeY, double resolution,
+                      double originX, double originY, const unsigned char* costs, const float* clearance);
+
+    virtual bool isFree(const Eigen::VectorXd& p) override;
+    virtual bool isVoronoiFree(const Eigen::VectorXd& p) override;
+    virtual unsigned char getCost(const Eigen::VectorXd& p) override;
+    virtual bool insideBound(const Eigen::VectorXd& p) override;
+    virtual Eigen::VectorXd getOutsidePoint() override;
+    virtual bool getChangedBounds(Bounds& changed) override;
+    virtual bool reportsChanges() override;
+    virtual bool getGrid(GridGeometry& grid) override;
+    virtual bool isFreeGridCell(int mx, int my) override;
+    virtual void isFreeBatch(const Eigen::Matrix2Xd& points, bool* out) override;
+    virtual double getClearance(const Eigen::VectorXd& p) override;
+
+    inline bool worldToMap(double wx, double wy, int& mx, int& my) const
+    {
+        double fx = (wx - header->originX) / header->resolution;
+        double fy = (wy - header->originY) / header->resolution;
+
+        if(!(fx >= 0 && fy >= 0 && fx < header->sizeX && fy < header->sizeY))
+            return false;
+
+        mx = static_cast<int>(fx);
+        my = static_cast<int>(fy);
+        return true;
+    }
+
+    inline std::size_t tileIndex(int mx, int my) const
+    {
+        return static_cast<std::size_t>(my >> TILE_BITS) * header->tilesX + (mx >> TILE_BITS);
+    }
+
+    inline int cellIndex(int mx, int my) const
+    {
+        return ((my & (TILE_SIZE - 1)) << TILE_BITS) | (mx & (TILE_SIZE - 1));
+    }
+
+    inline bool isFreeCell(int mx, int my) const
+    {
+        const uint64_t* tile = freeBits + tileIndex(mx, my) * TILE_SIZE;
+        return (tile[my & (TILE_SIZE - 1)] >> (mx & (TILE_SIZE - 1))) & 1;
+    }
+
+    inline unsigned char getCostCell(int mx, int my) const
+    {
+        return costs[tileIndex(mx, my) * TILE_CELLS + cellIndex(mx, my)];
+    }
+
+    inline bool hasClearance() const
+    {
+        return clearance != nullptr;
+    }
+
+    inline int getSizeX() const
+    {
+        return header->sizeX;
+    }
+
+    inline int getSizeY() const
+    {
+        return header->sizeY;
+    }
+
+    virtual ~MappedMap();
+
+private:
+    void* data;
+    std::size_t length;
+
+    const Header* header;
+    const unsigned char* costs;
+    const uint64_t* freeBits;
+    const float* clearance;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_MAPPEDMAP_H_ */
@@ -0,0 +1,139 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_OBSTACLECONTOURS_H_
+#define INCLUDE_RRT_PLANNING_MAP_OBSTACLECONTOURS_H_
+
+#include <vector>
+#include <Eigen/Dense>
+
+#include "rrt_planning/map/Map.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Obstacle boundaries of a map traced into polygons. Marching squares follows
+ * the borders between free and blocked cells, where leaving the map counts as
+ * blocked, and Douglas-Peucker simplifies each loop within a tolerance.
+ * Only tolerance 0 keeps the polygons on the cell borders, a positive one
+ * moves the edges by up to that distance across free and blocked cells.
+ * Polygons run with the obstacle on their left, edge i goes from vertex i to
+ * the next vertex of its polygon. The edges are indexed in a grid of buckets,
+ * so that a query only tests the edges close to it, at any map resolution.
+ */
+class ObstacleContours
+{
+public:
+    struct Crossing
+    {
+        double t;
+        bool entering;
+        int edge;
+    };
+
+    //Side of the buckets of the edge index, in cells
+    static const int BUCKET_SIZE = 8;
+
+public:
+    ObstacleContours();
+
+    //Traces the map, false if it is not backed by a grid
+    bool build(Map& map, double tolerance);
+
+    //Crossings of the segment a + t*(b - a) with the boundaries, for t in (0, 1], sorted by t
+    void intersect(const Eigen::Vector2d& a, const Eigen::Vector2d& b, std::vector<Crossing>& crossings);
+
+    //True if the segment from a to b crosses no boundary, cheaper than intersect
+    bool isClear(const Eigen::Vector2d& a, const Eigen::Vector2d& b) const;
+
+    //Parameter t where the ray origin + t*direction leaves the map, 0 if it starts outside
+    double leave(const Eigen::Vector2d& origin, const Eigen::Vector2d& direction) const;
+
+    //True if a convex vertex within radius faces p, or no boundary lies within radius
+    bool isCorner(const Eigen::Vector2d& p, double radius);
+
+    inline const Eigen::Vector2d& getVertex(int i) const
+    {
+        return vertices[i];
+    }
+
+    inline int getNext(int i) const
+    {
+        return next[i];
+    }
+
+    inline int getPrevious(int i) const
+    {
+        return previous[i];
+    }
+
+    inline bool isConvex(int i) const
+    {
+        return convex[i];
+    }
+
+    inline int getVertices() const
+    {
+        return vertices.size();
+    }
+
+    inline int getPolygons() const
+    {
+        return polygons;
+    }
+
+private:
+    bool crosses(int edge, const Eigen::Vector2d& a, const Eigen::Vector2d& d, double& t) const;
+    void trace(const std::vector<char>& blocked, double tolerance);
+    void simplify(std::vector<Eigen::Vector2i>& loop, double tolerance) const;
+    void simplify(const std::vector<Eigen::Vector2i>& loop, int first, int last, double tolerance,
+                  std::vector<bool>& keep) const;
+    void addPolygon(const std::vector<Eigen::Vector2i>& loop);
+    void index();
+    void collect(const Eigen::Vector2d& a, const Eigen::Vector2d& b, double radius);
+
+private:
+    GridGeometry grid;
+    int polygons;
+
+    std::vector<Eigen::Vector2d> vertices;
+    std::vector<int> next;
+    std::vector<int> previous;
+    std::vector<bool> convex;
+
+    //Edges of each bucket, stored contiguously
+    int bucketsX;
+    int bucketsY;
+    std::vector<int> bucketStart;
+    std::vector<int> bucketEdges;
+
+    //Edges found by the last query, each one once
+    std::vector<int> candidates;
+    std::vector<unsigned int> stamps;
+    unsigned int stamp;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_OBSTACLECONTOURS_H_ */
@@ -0,0 +1,103 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_OCCUPANCYPYRAMID_H_
+#define INCLUDE_RRT_PLANNING_MAP_OCCUPANCYPYRAMID_H_
+
+#include <vector>
+#include <Eigen/Dense>
+
+#include "rrt_planning/map/TiledLayer.h"
+
+namespace rrt_planning
+{
+
+class MapVersion;
+
+/*
+ * Max pooled occupancy of a map version. Level 0 marks the non free cells,
+ * a block of level k is blocked if any of its 2x2 children of level k-1 is
+ * blocked or lies outside the map. The last level is a single block.
+ * All the coordinates are in cells of level 0. The levels are tiled, so
+ * that a windowed update copies only the tiles of the blocks it changes.
+ */
+class OccupancyPyramid
+{
+public:
+    OccupancyPyramid();
+
+    void update(const MapVersion& map);
+    void update(const MapVersion& map, int minX, int minY, int maxX, int maxY);
+
+    inline bool isBlocked(int level, int bx, int by) const
+    {
+        return levels[level](bx, by);
+    }
+
+    //Highest level whose block around the cell is free, -1 if the cell is blocked
+    inline int freeLevel(int mx, int my) const
+    {
+        int level = -1;
+
+        while(level + 1 < getLevels() && !isBlocked(level + 1, mx >> (level + 1), my >> (level + 1)))
+            level++;
+
+        return level;
+    }
+
+    //True if every point within radius of the segment a-b lies in a free cell
+    bool isCorridorFree(const Eigen::Vector2d& a, const Eigen::Vector2d& b, double radius) const;
+
+    //Largest t such that the corridor of a-b up to a + t*(b - a) is free, above 1 if all of it is
+    double freeFraction(const Eigen::Vector2d& a, const Eigen::Vector2d& b, double radius) const;
+
+    inline int getLevels() const
+    {
+        return levels.size();
+    }
+
+private:
+    //Blocks are written only when they change, so that unchanged tiles stay shared
+    inline void set(int level, int bx, int by, unsigned char blocked)
+    {
+        if(levels[level](bx, by) != blocked)
+            levels[level].at(bx, by) = blocked;
+    }
+
+    void pool(int level, int minX, int minY, int maxX, int maxY);
+    bool isCorridorFree(int level, int bx, int by, const Eigen::Vector2d& a,
+                        const Eigen::Vector2d& b, double radius) const;
+    double firstBlocked(int level, int bx, int by, const Eigen::Vector2d& a,
+                        const Eigen::Vector2d& b, double radius, double first) const;
+    void getRoots(const Eigen::Vector2d& min, const Eigen::Vector2d& max,
+                  int& level, int& minX, int& minY, int& maxX, int& maxY) const;
+    bool intersects(int level, int bx, int by, const Eigen::Vector2d& a,
+                    const Eigen::Vector2d& b, double radius, double& t0) const;
+
+private:
+    std::vector<TiledLayer<unsigned char>> levels;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_OCCUPANCYPYRAMID_H_ */
@@ -41,6 +41,8 @@ public:
     virtual unsigned char getCost(const Eigen::VectorXd& p) override;
     virtual bool insideBound(const Eigen::VectorXd& p) override;
     virtual Eigen::VectorXd getOutsidePoint() override;
+    virtual bool getGrid(GridGeometry& grid) override;
+    virtual bool isFreeGridCell(int mx, int my) override;
 
     virtual ~ROSMap();
 
@@ -0,0 +1,120 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_RAYCASTER_H_
+#define INCLUDE_RRT_PLANNING_MAP_RAYCASTER_H_
+
+#include <Eigen/Dense>
+#include "rrt_planning/map/Map.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Exact traversal of the map cells crossed by the ray origin + t*direction,
+ * with t in [0, tMax], following Amanatides and Woo. Each crossed cell is
+ * visited once, together with the ray parameters where the ray enters and
+ * leaves it. Maps without a grid are traversed on a virtual grid of the
+ * given resolution, testing the middle of the ray inside each cell.
+ */
+class RayCaster
+{
+public:
+    RayCaster(Map& map);
+
+    void start(const Eigen::Vector2d& origin, const Eigen::Vector2d& direction, double tMax, double resolution);
+
+    //Moves to the next cell crossed by the ray, false if the ray ends in the current one
+    bool next();
+
+    //Jumps over the cells the map knows to be free, false if none was skipped
+    bool skipFree();
+
+    bool isFree();
+    bool isInside();
+
+    //First point of the ray inside the current cell
+    Eigen::Vector2d getEntryPoint() const;
+
+    //Last point of the ray inside the previous cell
+    Eigen::Vector2d getBeforePoint() const;
+
+    inline Eigen::Vector2d getPoint(double t) const
+    {
+        return origin + t*direction;
+    }
+
+    inline double getEntry() const
+    {
+        return entry;
+    }
+
+    inline double getExit() const
+    {
+        return exit;
+    }
+
+    inline int getX() const
+    {
+        return mx;
+    }
+
+    inline int getY() const
+    {
+        return my;
+    }
+
+private:
+    void seed(double t);
+    double getMiddle() const;
+
+private:
+    Map& map;
+    bool gridded;
+    GridGeometry grid;
+
+    Eigen::Vector2d origin;
+    Eigen::Vector2d direction;
+    double tMax;
+    double nudge;
+
+    //Current cell and the ray parameters of its borders
+    int mx;
+    int my;
+    double previous;
+    double entry;
+    double exit;
+    bool seeded;
+
+    //Amanatides-Woo state
+    int stepX;
+    int stepY;
+    double tMaxX;
+    double tMaxY;
+    double tDeltaX;
+    double tDeltaY;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_RAYCASTER_H_ */
@@ -2,6 +2,9 @@
 #define INCLUDE_RRT_PLANNING_MAP_SGMAP_H_
 
 #include "rrt_planning/map/Map.h"
+#include "rrt_planning/map/ObstacleContours.h"
+#include "rrt_planning/map/RayCaster.h"
+#include "rrt_planning/map/SegmentCache.h"
 #include "costmap_2d/costmap_2d_ros.h"
 #include "costmap_2d/costmap_2d.h"
 #include "rrt_planning/nh/Triangle.h"
@@ -15,6 +18,9 @@ public:
     SGMap(Map& map);
     void initialize(ros::NodeHandle& nh);
 
+    //Refresh the data derived from the map, after each map update
+    void update();
+
     bool collisionPoints(const Eigen::VectorXd& a, const Eigen::VectorXd& b, std::vector<Eigen::VectorXd>& actions);
     Eigen::VectorXd exitPoint(const Eigen::VectorXd& current, const Eigen::VectorXd& middle, bool cw);
     std::vector<Eigen::VectorXd> infiniteExitPoint(const Eigen::VectorXd& current, const Eigen::VectorXd& middle, bool cw);
@@ -29,6 +35,17 @@ public:
     virtual ~SGMap();
 
 
+private:
+  bool traceSegment(const Eigen::VectorXd& a, const Eigen::VectorXd& b, std::vector<Eigen::VectorXd>& actions);
+  Eigen::VectorXd withPosition(const Eigen::VectorXd& state, const Eigen::Vector2d& p);
+  Eigen::Vector2d exitDirection(const Eigen::VectorXd& current, const Eigen::VectorXd& middle, bool cw);
+
+  //Changes of the free state along a ray, found on the contours or cell by cell.
+  //Unbounded rays stop at the map border, startRay returns the state at the origin
+  bool startRay(const Eigen::Vector2d& origin, const Eigen::Vector2d& direction, double tMax);
+  bool nextChange(bool& free, Eigen::Vector2d& before, Eigen::Vector2d& entry);
+  Eigen::Vector2d getRayEnd();
+
 private:
   Map& map;
 
@@ -44,6 +61,35 @@ private:
   double micro;
   double step;
 
+  //contour parameters
+  bool use_contours;
+  double contour_tolerance;
+
+  //results of collisionPoints, valid until the map changes
+  SegmentCache cache;
+
+  //cell traversal of the rays
+  RayCaster caster;
+
+  //obstacle polygons, used instead of the cells once built
+  ObstacleContours contours;
+  bool contoursReady;
+
+  //state of the current ray
+  bool rayFree;
+  bool rayBounded;
+  bool rayDone;
+  Eigen::Vector2d rayOrigin;
+  Eigen::Vector2d raySegment;
+  double rayNudge;
+  std::vector<ObstacleContours::Crossing> crossings;
+  std::size_t crossingIndex;
+
+  //batched query buffers
+  Eigen::Matrix2Xd circle;
+  Eigen::Matrix2Xd cornerSamples;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> cornerFree;
+
 };
 
 }
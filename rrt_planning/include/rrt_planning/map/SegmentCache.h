@@ -0,0 +1,84 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_SEGMENTCACHE_H_
+#define INCLUDE_RRT_PLANNING_MAP_SEGMENTCACHE_H_
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Dense>
+
+namespace rrt_planning
+{
+
+/*
+ * Results of the segment collision checks, keyed on the segment endpoints
+ * rounded to a quantum. The table has a fixed number of slots, a new segment
+ * replaces the one in its slot, and clear() only advances a generation.
+ */
+class SegmentCache
+{
+public:
+    struct Entry
+    {
+        int64_t key[4];
+        unsigned int generation;
+        bool result;
+        int points;
+        double x[2];
+        double y[2];
+        bool fromEnd[2];
+    };
+
+public:
+    SegmentCache();
+
+    //Size is rounded up to a power of two, 0 disables the cache
+    void initialize(int size, double quantum);
+    void clear();
+
+    //Entry of the segment a-b, nullptr on a miss
+    const Entry* find(const Eigen::Vector2d& a, const Eigen::Vector2d& b);
+
+    //Stores the points of the check of a-b, those equal to fromEnd come from the state at b
+    void insert(const Eigen::Vector2d& a, const Eigen::Vector2d& b, bool result,
+                const std::vector<Eigen::VectorXd>& points, const Eigen::VectorXd& end);
+
+    inline bool isEnabled() const
+    {
+        return !slots.empty();
+    }
+
+private:
+    std::size_t computeKey(const Eigen::Vector2d& a, const Eigen::Vector2d& b, int64_t* key) const;
+
+private:
+    std::vector<Entry> slots;
+    std::size_t mask;
+    double quantum;
+    unsigned int generation;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_SEGMENTCACHE_H_ */
@@ -0,0 +1,202 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_SNAPSHOTMAP_H_
+#define INCLUDE_RRT_PLANNING_MAP_SNAPSHOTMAP_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rrt_planning/map/Map.h"
+#include "rrt_planning/map/MapVersion.h"
+#include "costmap_2d/costmap_2d_ros.h"
+#include "costmap_2d/costmap_2d.h"
+
+#include <boost/thread/mutex.hpp>
+#include <map_msgs/OccupancyGridUpdate.h>
+#include <ros/ros.h>
+
+//AVX2 batch kernels, selected at runtime on CPUs that support them
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RRT_PLANNING_AVX2
+#endif
+
+namespace rrt_planning
+{
+
+class ClearanceField;
+
+/*
+ * Tiled copy of the costmap, published as immutable versions. The free and
+ * voronoi free tests are stored as bit planes, so that the collision queries
+ * never touch the live costmap. Ray and corridor queries skip the free blocks
+ * of an occupancy pyramid built with each version, the optional clearance
+ * and corner layers are built with it too.
+ * update() pins the latest published version for the whole planning query.
+ * By default it also publishes a fresh copy first. In incremental mode the
+ * windows announced on the costmap updates topic are published by the
+ * subscriber callback instead, so that pinning never waits for the costmap.
+ */
+class SnapshotMap : public Map
+{
+public:
+    SnapshotMap(costmap_2d::Costmap2DROS* costmap_ros);
+
+    //Static map built from a raw cost grid, update() keeps it unchanged
+    SnapshotMap(int sizeX, int sizeY, double resolution, double originX, double originY,
+                const unsigned char* costs);
+
+    virtual bool isFree(const Eigen::VectorXd& p) override;
+    virtual bool isVoronoiFree(const Eigen::VectorXd& p) override;
+    virtual unsigned char getCost(const Eigen::VectorXd& p) override;
+    virtual bool insideBound(const Eigen::VectorXd& p) override;
+    virtual Eigen::VectorXd getOutsidePoint() override;
+    virtual void update() override;
+    virtual void isFreeBatch(const Eigen::Matrix2Xd& points, bool* out) override;
+    virtual bool getChangedBounds(Bounds& changed) override;
+    virtual bool reportsChanges() override;
+    virtual bool getGrid(GridGeometry& grid) override;
+    virtual bool isFreeGridCell(int mx, int my) override;
+    virtual double getClearance(const Eigen::VectorXd& p) override;
+    virtual int freeSteps(const Eigen::Vector2d& p, const Eigen::Vector2d& delta) override;
+    virtual bool isCorridorFree(const Eigen::VectorXd& a, const Eigen::VectorXd& b, double radius) override;
+    virtual double getFreeFraction(const Eigen::VectorXd& a, const Eigen::VectorXd& b, double radius) override;
+    virtual bool hasCorners() override;
+    virtual bool isCorner(const Eigen::VectorXd& p, double radius) override;
+
+    void enableClearance();
+    void enableCorners(double radius, double threshold);
+    void enableIncremental(ros::NodeHandle& nh);
+
+    //Version pinned by the last update, valid until the next one
+    inline const MapVersion& getPinned() const
+    {
+        return *current;
+    }
+
+    inline bool worldToMap(double wx, double wy, int& mx, int& my) const
+    {
+        return current->worldToMap(wx, wy, mx, my);
+    }
+
+    inline bool isFreeCell(int mx, int my) const
+    {
+        return current->isFreeCell(mx, my);
+    }
+
+    inline bool isVoronoiFreeCell(int mx, int my) const
+    {
+        return current->isVoronoiFreeCell(mx, my);
+    }
+
+    inline unsigned char getCostCell(int mx, int my) const
+    {
+        return current->getCostCell(mx, my);
+    }
+
+    inline bool isFree(double wx, double wy) const
+    {
+        int mx, my;
+        return current->worldToMap(wx, wy, mx, my) && current->isFreeCell(mx, my);
+    }
+
+    inline int getSizeX() const
+    {
+        return current->getSizeX();
+    }
+
+    inline int getSizeY() const
+    {
+        return current->getSizeY();
+    }
+
+    inline double getResolution() const
+    {
+        return current->getResolution();
+    }
+
+    inline double getOriginX() const
+    {
+        return current->getOriginX();
+    }
+
+    inline double getOriginY() const
+    {
+        return current->getOriginY();
+    }
+
+    inline unsigned int getVersion() const
+    {
+        return current->getNumber();
+    }
+
+    virtual ~SnapshotMap();
+
+private:
+    void initialize();
+    void pin();
+    void costmapUpdateCallback(const map_msgs::OccupancyGridUpdate::ConstPtr& msg);
+    bool isOutdated(const MapVersion& version);
+    static bool isSameGrid(const costmap_2d::Costmap2D& costmap, const MapVersion& version);
+    void publishFull();
+    void buildFull();
+    void publishWindow(int minX, int minY, int maxX, int maxY);
+    void publish(MapVersion* version);
+    int freeStepsCell(int mx, int my, const Eigen::Vector2d& p, const Eigen::Vector2d& delta) const;
+    void isFreeKernel(const double* points, int n, bool* out) const;
+#ifdef RRT_PLANNING_AVX2
+    void isFreeKernelAVX2(const double* points, int n, bool* out) const;
+#endif
+
+private:
+    costmap_2d::Costmap2DROS* costmap_ros;
+    bool useAVX2;
+
+    //Latest version, only accessed through the atomic shared_ptr functions
+    std::shared_ptr<const MapVersion> published;
+
+    //Reader side, the version used by the current query
+    std::shared_ptr<const MapVersion> pinned;
+    const MapVersion* current;
+
+    //Writer side, serialized by the publish mutex
+    boost::mutex publishMutex;
+    unsigned int lastNumber;
+    ClearanceField* clearanceField;
+    double cornerRadius;
+    double cornerThreshold;
+    bool incremental;
+    ros::Subscriber updateSubscriber;
+
+    //Cells changed between the last two pinned versions
+    bool changedKnown;
+    int changedMinX;
+    int changedMinY;
+    int changedMaxX;
+    int changedMaxY;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_SNAPSHOTMAP_H_ */
@@ -0,0 +1,184 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_TILEDLAYER_H_
+#define INCLUDE_RRT_PLANNING_MAP_TILEDLAYER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace rrt_planning
+{
+
+/*
+ * Grid of values split in tiles of 2^SHIFT_X x 2^SHIFT_Y elements, each held
+ * by a shared_ptr. A copy shares all the tiles of the original, and a tile
+ * is copied the first time the copy writes into it, so that a map version
+ * built from the previous one copies only the tiles that actually change.
+ * The tiles shared with a copy are never written again.
+ */
+template<class T, int SHIFT_X = 6, int SHIFT_Y = 6>
+class TiledLayer
+{
+public:
+    static const int TILE_X = 1 << SHIFT_X;
+    static const int TILE_Y = 1 << SHIFT_Y;
+
+public:
+    TiledLayer() : sizeX(0), sizeY(0), tilesX(0)
+    {
+    }
+
+    TiledLayer(const TiledLayer& other) : sizeX(other.sizeX), sizeY(other.sizeY), tilesX(other.tilesX),
+        tiles(other.tiles), data(other.data), owned(other.tiles.size(), false)
+    {
+    }
+
+    TiledLayer& operator=(const TiledLayer& other)
+    {
+        sizeX = other.sizeX;
+        sizeY = other.sizeY;
+        tilesX = other.tilesX;
+        tiles = other.tiles;
+        data = other.data;
+        owned.assign(tiles.size(), false);
+
+        return *this;
+    }
+
+    //Fresh tiles, all set to value
+    void assign(int sizeX, int sizeY, const T& value)
+    {
+        this->sizeX = sizeX;
+        this->sizeY = sizeY;
+        tilesX = (sizeX + TILE_X - 1) >> SHIFT_X;
+
+        std::size_t count = static_cast<std::size_t>(tilesX) * ((sizeY + TILE_Y - 1) >> SHIFT_Y);
+        tiles.resize(count);
+        data.resize(count);
+        owned.assign(count, true);
+
+        for(std::size_t i = 0; i < count; i++)
+        {
+            tiles[i] = std::make_shared<std::vector<T>>(TILE_X * TILE_Y, value);
+            data[i] = tiles[i]->data();
+        }
+    }
+
+    void clear()
+    {
+        sizeX = sizeY = tilesX = 0;
+        tiles.clear();
+        data.clear();
+        owned.clear();
+    }
+
+    inline bool empty() const
+    {
+        return tiles.empty();
+    }
+
+    inline int getSizeX() const
+    {
+        return sizeX;
+    }
+
+    inline int getSizeY() const
+    {
+        return sizeY;
+    }
+
+    inline const T& operator()(int x, int y) const
+    {
+        return data[tile(x, y)][element(x, y)];
+    }
+
+    //Writable element, copying its tile if shared
+    inline T& at(int x, int y)
+    {
+        std::size_t index = tile(x, y);
+
+        if(!owned[index])
+            copy(index);
+
+        return data[index][element(x, y)];
+    }
+
+    //Writes n elements of row y from x on
+    void setRow(int x, int y, const T* values, int n)
+    {
+        while(n > 0)
+        {
+            int length = std::min(n, TILE_X - (x & (TILE_X - 1)));
+            std::copy(values, values + length, &at(x, y));
+
+            x += length;
+            values += length;
+            n -= length;
+        }
+    }
+
+    //Tile pointers and their layout, for the vectorized readers
+    inline const T* const* getTiles() const
+    {
+        return data.data();
+    }
+
+    inline int getTilesX() const
+    {
+        return tilesX;
+    }
+
+    inline std::size_t tile(int x, int y) const
+    {
+        return static_cast<std::size_t>(y >> SHIFT_Y) * tilesX + (x >> SHIFT_X);
+    }
+
+    static inline std::size_t element(int x, int y)
+    {
+        return static_cast<std::size_t>(y & (TILE_Y - 1)) * TILE_X + (x & (TILE_X - 1));
+    }
+
+private:
+    void copy(std::size_t index)
+    {
+        tiles[index] = std::make_shared<std::vector<T>>(*tiles[index]);
+        data[index] = tiles[index]->data();
+        owned[index] = true;
+    }
+
+private:
+    int sizeX;
+    int sizeY;
+    int tilesX;
+
+    std::vector<std::shared_ptr<std::vector<T>>> tiles;
+    std::vector<T*> data;
+    std::vector<bool> owned;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_TILEDLAYER_H_ */
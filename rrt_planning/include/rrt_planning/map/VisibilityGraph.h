@@ -0,0 +1,108 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_MAP_VISIBILITYGRAPH_H_
+#define INCLUDE_RRT_PLANNING_MAP_VISIBILITYGRAPH_H_
+
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "rrt_planning/map/ObstacleContours.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Visibility graph between the convex corners of the obstacle contours.
+ * Only the bitangent edges are kept, as a shortest path can bend only around
+ * a corner it is tangent to. For each goal a backward Dijkstra labels every
+ * corner with its shortest path length, so the Euclidean shortest path from
+ * any point is the best of the corners it sees. The corner chosen for a cell
+ * is remembered, and bounds the search of the points of the cell that see it.
+ */
+class VisibilityGraph
+{
+public:
+    VisibilityGraph(Map& map);
+
+    //Rebuilds the graph if the map changed since the last build
+    void update(double tolerance);
+
+    //Labels the corners with their distance from the goal
+    void setGoal(const Eigen::Vector2d& goal);
+
+    //Length of the shortest path from p to the goal, infinity if unknown
+    double distance(const Eigen::Vector2d& p);
+
+    inline bool isReady() const
+    {
+        return ready;
+    }
+
+    inline int getNodes() const
+    {
+        return nodes.size();
+    }
+
+    inline int getEdges() const
+    {
+        return edgeTargets.size();
+    }
+
+private:
+    void build(double tolerance);
+    int search(const Eigen::Vector2d& p, int hint);
+    bool isTangent(int node, const Eigen::Vector2d& p) const;
+
+private:
+    Map& map;
+    ObstacleContours contours;
+    GridGeometry grid;
+    bool ready;
+
+    //Corners moved slightly out of the obstacles, with their contour vertex
+    std::vector<Eigen::Vector2d> nodes;
+    std::vector<int> corners;
+
+    //Adjacency of each node, stored contiguously
+    std::vector<int> edgeStart;
+    std::vector<int> edgeTargets;
+    std::vector<double> edgeLengths;
+
+    //Labels for the current goal
+    Eigen::Vector2d goal;
+    std::vector<double> labels;
+    std::vector<int> labeled;
+
+    //Corner through which each cell reaches the goal, GOAL if directly
+    std::unordered_map<std::size_t, int> via;
+    std::vector<std::pair<double, int> > queue;
+
+    static const int GOAL = -1;
+    static const int NONE = -2;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_MAP_VISIBILITYGRAPH_H_ */
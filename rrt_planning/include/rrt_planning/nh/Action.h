@@ -1,39 +1,45 @@
 #ifndef INCLUDE_RRT_PLANNING_NH_ACTION_H
 #define INCLUDE_RRT_PLANNING_NH_ACTION_H
 
-#include <memory>
 #include <Eigen/Dense>
 
 namespace rrt_planning
 {
+/*
+ * Target of a NH search step. The parent is the index of an action in the
+ * action pool of the query, NONE if the action has no parent.
+ */
 class Action
 {
 public:
-    inline Action(){}
-    inline Action(const Eigen::VectorXd& state, bool cw, bool sample, bool corner, std::shared_ptr<Action> parent):
-                  state(state), cw(cw), sample(sample), corner(corner), parent(parent) {}
-    inline Action(const Eigen::VectorXd& state, const Eigen::VectorXd& middle, bool cw,
-                  bool sample, bool corner, std::shared_ptr<Action> parent):
+    static const int NONE = -1;
+
+    inline Action() : state(Eigen::Vector3d::Zero()), middle(Eigen::Vector3d::Zero()),
+                      cw(false), sample(false), corner(false), parent(NONE) {}
+    inline Action(const Eigen::Vector3d& state, bool cw, bool sample, bool corner, int parent):
+                  state(state), middle(Eigen::Vector3d::Zero()), cw(cw), sample(sample), corner(corner), parent(parent) {}
+    inline Action(const Eigen::Vector3d& state, const Eigen::Vector3d& middle, bool cw,
+                  bool sample, bool corner, int parent):
                   state(state), middle(middle), cw(cw), sample(sample), corner(corner), parent(parent) {}
 
-    Eigen::VectorXd getState() const {return state;}
-    Eigen::VectorXd getMiddle() const {return middle;}
+    const Eigen::Vector3d& getState() const {return state;}
+    const Eigen::Vector3d& getMiddle() const {return middle;}
     bool isClockwise() const {return cw;}
     bool isSubgoal() const {return sample;}
     bool isCorner() const {return corner;}
-    std::shared_ptr<Action> getParent() const {return parent;}
-    void setParent(std::shared_ptr<Action> p) {parent = p;}
+    int getParent() const {return parent;}
+    void setParent(int p) {parent = p;}
     void setCorner(bool isCorner) {corner = isCorner;}
-    void setState(Eigen::VectorXd& new_state) {state = new_state;}
+    void setState(const Eigen::Vector3d& new_state) {state = new_state;}
 
 
 private:
-    Eigen::VectorXd state;
-    Eigen::VectorXd middle;
+    Eigen::Vector3d state;
+    Eigen::Vector3d middle;
     bool cw;
     bool sample;
     bool corner;
-    std::shared_ptr<Action> parent;
+    int parent;
 };
 }
 
@@ -1,86 +1,93 @@
 #ifndef INCLUDE_RRT_PLANNING_NH_CORNERINDEX_H_
 #define INCLUDE_RRT_PLANNING_NH_CORNERINDEX_H_
 
-#include "rrt_planning/rrt/Cover_Tree.h"
+#include <cmath>
+#include <vector>
+#include <Eigen/Dense>
+#include "rrt_planning/nh/StateTable.h"
+#include "rrt_planning/utils/Stats.h"
 
 namespace rrt_planning
 {
 
-class CornerCoverWrapper
+/*
+ * Corners of a NH query, hashed on a grid of square cells as large as the
+ * merge radius, so that the corners within the radius of a point lie in the
+ * 3x3 cells around it. clear() keeps the cells for the next query.
+ */
+class CornerIndex
 {
 public:
-    CornerCoverWrapper(Distance* distance, Eigen::VectorXd& corner) : dist(distance), corner(corner)
+    explicit CornerIndex(double radius = 1.0)
     {
-
-    }
-
-    inline bool operator ==(const CornerCoverWrapper& obj) const
-    {
-        return obj.corner == this->corner;
-    }
-
-    inline double distance(const CornerCoverWrapper& obj) const
-    {
-        auto& dist = *this->dist;
-        return dist(obj.corner, this->corner);
+        setRadius(radius);
     }
 
-    inline Eigen::VectorXd getCorner() const
+    inline void setRadius(double radius)
     {
-        return corner;
+        this->radius = radius;
+        cells.setResolution(radius, 2 * M_PI);
     }
 
-private:
-    Eigen::VectorXd corner;
-    Distance* dist;
-};
-
-class CornerIndex : CoverTree<CornerCoverWrapper>
-{
-public:
-
-    CornerIndex(Distance& dist) : dist(dist), CoverTree<CornerCoverWrapper>(1e3)
+    inline void insert(const Eigen::Vector3d& p)
     {
+        Stats::count(Stats::INDEX_INSERT);
 
-    }
-
-    inline void insert(Eigen::VectorXd& p)
-    {
-        CoverTree<CornerCoverWrapper>::insert(CornerCoverWrapper(&dist, p));
-    }
+        //A recycled cell keeps the corners of an old query
+        std::vector<Eigen::Vector3d>* cell = cells.find(p.head<2>());
+        if(!cell)
+        {
+            cell = &cells[p.head<2>()];
+            cell->clear();
+        }
 
-    inline void remove(Eigen::VectorXd& p)
-    {
-        CoverTree<CornerCoverWrapper>::remove(CornerCoverWrapper(&dist, p));
+        cell->push_back(p);
     }
 
-    inline Eigen::VectorXd getNearestNeighbour(const Eigen::VectorXd& x)
+    //The nearest corner closer than the radius to p, false if there is none
+    inline bool findNearest(const Eigen::Vector3d& p, Eigen::Vector3d& nearest)
     {
-        Eigen::VectorXd tmp = x;
-        CornerCoverWrapper tmpWrapped(&dist, tmp);
-        auto result = CoverTree<CornerCoverWrapper>::kNearestNeighbors(tmpWrapped, 1);
-
-        return result.back().getCorner();
-    }
+        Stats::count(Stats::INDEX_NEAREST);
+        StatsTimer timer(Stats::INDEX_NEAREST_TIME);
 
-    inline std::vector<Eigen::VectorXd> getNearestNeighbours(const Eigen::VectorXd& x, int k)
-    {
-        Eigen::VectorXd tmp = x;
-        CornerCoverWrapper tmpWrapped(&dist, tmp);
-        auto result = CoverTree<CornerCoverWrapper>::kNearestNeighbors(tmpWrapped, k);
+        double x = std::floor(p(0) / radius + 0.5);
+        double y = std::floor(p(1) / radius + 0.5);
+        double best = radius;
+        bool found = false;
 
-        std::vector<Eigen::VectorXd> neighbors;
-        for (auto n: result)
+        for(int dx = -1; dx <= 1; dx++)
         {
-          neighbors.push_back(n.getCorner());
+            for(int dy = -1; dy <= 1; dy++)
+            {
+                Eigen::Vector2d center((x + dx) * radius, (y + dy) * radius);
+                const std::vector<Eigen::Vector3d>* cell = cells.find(center);
+                if(!cell)
+                    continue;
+
+                for(const Eigen::Vector3d& corner : *cell)
+                {
+                    double d = (corner.head<2>() - p.head<2>()).norm();
+                    if(d < best)
+                    {
+                        best = d;
+                        nearest = corner;
+                        found = true;
+                    }
+                }
+            }
         }
 
-        return neighbors;
+        return found;
     }
 
+    inline void clear()
+    {
+        cells.clear();
+    }
 
 private:
-    Distance& dist;
+    double radius;
+    StateTable<std::vector<Eigen::Vector3d> > cells;
 };
 
 }
@@ -2,10 +2,11 @@
 #define INCLUDE_RRT_PLANNING_NH_NODE_H
 
 #include <cassert>
-#include <set>
+#include <vector>
 #include <Eigen/Dense>
 #include "rrt_planning/nh/Action.h"
 #include "rrt_planning/nh/Triangle.h"
+#include "rrt_planning/nh/TriangleSet.h"
 
 
 namespace rrt_planning
@@ -17,29 +18,34 @@ class Node
 {
 public:
     Node();
-    Node(const Eigen::VectorXd& state, Node* parent, double cost);
-    Node(const Eigen::VectorXd& state, Node* parent, double cost, std::vector<Eigen::VectorXd> mp);
+    Node(const Eigen::Vector3d& state, Node* parent, double cost);
+    Node(const Eigen::Vector3d& state, Node* parent, double cost, std::vector<Eigen::VectorXd> mp);
 
-    void addSubgoal(const Eigen::VectorXd& subgoal);
+    //Reinitializes a recycled node, keeping the capacity of its buffers
+    void initialize(const Eigen::Vector3d& state, Node* parent, double cost);
+    void setMotionPrimitives(const std::vector<Eigen::VectorXd>& mp);
+    void setMotionPrimitives(const std::vector<Eigen::Vector3d>& mp);
+
+    void addSubgoal(const Eigen::Vector3d& subgoal);
     void addTriangle(const Triangle& t);
-    bool insideArea(const Eigen::VectorXd& p);
-    bool contains(const Eigen::VectorXd& subgoal);
+    bool insideArea(const Eigen::Vector3d& p) const;
+    bool contains(const Eigen::Vector3d& subgoal) const;
 
     Node* setParent(Node* p);
 
     Node* getParent();
-    double getCost();
-    Eigen::VectorXd getState();
-    std::vector<Eigen::VectorXd> getMotionPrimitives();
+    double getCost() const;
+    const Eigen::Vector3d& getState() const;
+    const std::vector<Eigen::Vector3d>& getMotionPrimitives() const;
 
 
 private:
-    Eigen::VectorXd state;
+    Eigen::Vector3d state;
     Node* parent;
     double cost;
-    std::vector<Eigen::VectorXd> mp; //motion primitives to reach parent
-    std::set<Sub> subgoals;
-    std::vector<Triangle> closed_area;
+    std::vector<Eigen::Vector3d> mp; //motion primitives to reach parent
+    std::vector<Sub> subgoals;
+    TriangleSet closed_area;
 };
 
 }
@@ -3,63 +3,70 @@
 
 #include "rrt_planning/nh/Action.h"
 #include "rrt_planning/nh/Node.h"
-#include <math.h>
-#include <typeinfo>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace rrt_planning
 {
 
 typedef std::pair<Node*, Action> Key;
-typedef std::pair<rrt_planning::Key, double> Tuple;
 
-struct Cmp
-{
-    bool operator()(rrt_planning::Tuple a, rrt_planning::Tuple b)
-    {
-        return ((a.second < b.second)
-                || (a.second == b.second && a.first.first->getCost() < b.first.first->getCost())
-                || (a.second == b.second && a.first.first->getCost() == b.first.first->getCost() && eigenOrdering(a.first.first->getState(),b.first.first->getState()))
-                || (a.second == b.second && a.first.first->getCost() == b.first.first->getCost() && a.first.first->getState() == b.first.first->getState()
-                    && eigenOrdering(a.first.second.getState(), b.first.second.getState())));
-    }
-
-    bool eigenOrdering(const Eigen::VectorXd& a, const Eigen::VectorXd& b) const
-    {
-      return ((a(0) < b(0)) || (a(0) == b(0) && a(1) < b(1))
-              || (a(0) == b(0) && a(1) == b(1) && a(2) < b(2)));
-    }
-
-};
-
-}
+/*
+ * Open list of the NH search. A 4-ary heap of compact entries points into a
+ * pool of keys, ordered by value, then node cost, node state and action state.
+ * A node and action state already open keep only their best value, so insert
+ * doubles as decrease-key. Popped slots are reused, the list allocates only
+ * while it grows.
+ */
 class OpenList
 {
 public:
-    OpenList() {}
+    OpenList();
 
-    void insert(const rrt_planning::Key& key, double value)
-    {
-        rrt_planning::Tuple new_pair(key, value);
-        open.insert(new_pair);
-    }
+    void insert(const Key& key, double value);
+    Key pop();
 
-    rrt_planning::Key pop()
+    //Recomputes the value of every open key and restores the heap
+    void rebuild(const std::function<double(const Key&)>& value);
+
+    bool empty() const {return heap.empty();}
+    int size() const {return heap.size();}
+    void clear();
+
+private:
+    struct Entry
     {
-      auto it = open.begin();
-      auto ptr = *it;
-      open.erase(it);
+        double value;
+        double cost;
+        uint32_t slot;
+    };
 
-      return ptr.first;
-    }
+    static const int ARITY = 4;
 
-    bool empty() const {return open.empty();}
-    int size() {return open.size();}
-    void clear() {open.clear();}
+    bool less(const Entry& a, const Entry& b) const;
+    void siftUp(int position);
+    void siftDown(int position);
+    void place(const Entry& entry, int position);
 
-    //~OpenList();
+    int find(Node* node, const Eigen::Vector3d& state) const;
+    std::size_t hash(Node* node, const Eigen::Vector3d& state) const;
+    void index(int slot);
+    void unindex(int slot);
 
 private:
-    std::set<rrt_planning::Tuple, rrt_planning::Cmp> open;
+    std::vector<Entry> heap;
+
+    //Pooled keys with their heap position
+    std::vector<Key> keys;
+    std::vector<int> positions;
+    std::vector<int> freeSlots;
+
+    //Open addressing table of the open slots, by node and action state
+    std::vector<int> table;
+    std::size_t mask;
 };
 
+}
+
 #endif // INCLUDE_RRT_PLANNING_NH_OPENLIST_H
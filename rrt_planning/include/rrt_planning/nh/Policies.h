@@ -0,0 +1,65 @@
+#ifndef INCLUDE_RRT_PLANNING_NH_POLICIES_H
+#define INCLUDE_RRT_PLANNING_NH_POLICIES_H
+
+#include <cmath>
+#include <vector>
+#include <Eigen/Dense>
+#include "rrt_planning/extenders/Extender.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Policies of the NH search. They are template arguments of NHPlannerBase,
+ * so their calls are resolved, and inlined, at compile time.
+ */
+
+//Planar distance, as L2Distance
+struct L2Metric
+{
+    template<class Derived1, class Derived2>
+    inline double operator()(const Eigen::MatrixBase<Derived1>& x1, const Eigen::MatrixBase<Derived2>& x2) const
+    {
+        return (x1.template head<2>() - x2.template head<2>()).norm();
+    }
+};
+
+//Angle between the headings, as ThetaDistance
+struct AngleMetric
+{
+    template<class Derived1, class Derived2>
+    inline double operator()(const Eigen::MatrixBase<Derived1>& x1, const Eigen::MatrixBase<Derived2>& x2) const
+    {
+        double angle = x1(2) - x2(2);
+        if(std::fabs(angle) > M_PI)
+        {
+            angle = (angle > 0) ? (angle - 2 * M_PI) : (angle + 2 * M_PI);
+        }
+
+        return std::fabs(angle);
+    }
+};
+
+//Steering with the cost of the extender distance
+struct Steer
+{
+    inline bool operator()(Extender& extender, const Eigen::VectorXd& xCurr, const Eigen::VectorXd& xTarget,
+                           Eigen::VectorXd& xNew, std::vector<Eigen::VectorXd>& parents, double& cost) const
+    {
+        return extender.steer(xCurr, xTarget, xNew, parents, cost);
+    }
+};
+
+//Steering with the planar length as cost
+struct SteerL2
+{
+    inline bool operator()(Extender& extender, const Eigen::VectorXd& xCurr, const Eigen::VectorXd& xTarget,
+                           Eigen::VectorXd& xNew, std::vector<Eigen::VectorXd>& parents, double& cost) const
+    {
+        return extender.steer_l2(xCurr, xTarget, xNew, parents, cost);
+    }
+};
+
+}
+
+#endif // INCLUDE_RRT_PLANNING_NH_POLICIES_H
@@ -0,0 +1,211 @@
+#ifndef INCLUDE_RRT_PLANNING_NH_STATETABLE_H
+#define INCLUDE_RRT_PLANNING_NH_STATETABLE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <Eigen/Dense>
+
+namespace rrt_planning
+{
+
+/*
+ * Open addressing table keyed on states (x, y, theta) quantized on a grid of
+ * the given resolutions, so that states closer than a cell share an entry.
+ * Planar keys, of size 2, use theta = 0. The angle is wrapped on the circle.
+ * clear() is O(1) and keeps the slots, with their values, for the next round,
+ * so the table allocates only while it grows.
+ */
+template<class T>
+class StateTable
+{
+public:
+    StateTable() : generation(1), count(0), mask(0)
+    {
+        setResolution(1e-6, 1e-6);
+    }
+
+    void setResolution(double resolution, double angleResolution)
+    {
+        if(resolution <= 0 || angleResolution <= 0)
+            throw std::runtime_error("State resolutions must be positive");
+
+        this->resolution = resolution;
+        bins = std::max<int64_t>(1, std::ceil(2 * M_PI / angleResolution));
+        binSize = 2 * M_PI / bins;
+    }
+
+    //The value of the cell of x, nullptr if not present
+    template<class Derived>
+    T* find(const Eigen::MatrixBase<Derived>& x)
+    {
+        if(count == 0)
+            return nullptr;
+
+        Key key = quantize(x);
+        for(std::size_t i = hash(key) & mask; slots[i].generation == generation; i = (i + 1) & mask)
+        {
+            if(slots[i].key == key)
+                return &slots[i].value;
+        }
+
+        return nullptr;
+    }
+
+    template<class Derived>
+    bool contains(const Eigen::MatrixBase<Derived>& x)
+    {
+        return find(x) != nullptr;
+    }
+
+    //The value of the cell of x, inserted if not present. A recycled value
+    //keeps its old content, the caller overwrites it
+    template<class Derived>
+    T& operator[](const Eigen::MatrixBase<Derived>& x)
+    {
+        Key key = quantize(x);
+
+        //Keep the table at most half full
+        if(2 * (count + 1) > slots.size())
+            grow();
+
+        std::size_t i = hash(key) & mask;
+        for(; slots[i].generation == generation; i = (i + 1) & mask)
+        {
+            if(slots[i].key == key)
+                return slots[i].value;
+        }
+
+        slots[i].key = key;
+        slots[i].generation = generation;
+        count++;
+
+        return slots[i].value;
+    }
+
+    //Drops the entries for which pred(position, value) holds, the position
+    //being the center of the planar cell of the entry
+    template<class Predicate>
+    void removeIf(Predicate pred)
+    {
+        std::vector<Slot> old(slots.size());
+        old.swap(slots);
+        count = 0;
+
+        for(Slot& slot : old)
+        {
+            if(slot.generation != generation)
+                continue;
+
+            Eigen::Vector2d position(slot.key.x * resolution, slot.key.y * resolution);
+            if(pred(position, slot.value))
+                continue;
+
+            std::size_t i = hash(slot.key) & mask;
+            while(slots[i].generation == generation)
+                i = (i + 1) & mask;
+
+            slots[i].key = slot.key;
+            slots[i].generation = generation;
+            slots[i].value = std::move(slot.value);
+            count++;
+        }
+    }
+
+    void clear()
+    {
+        generation++;
+        count = 0;
+    }
+
+    inline int size() const
+    {
+        return count;
+    }
+
+private:
+    struct Key
+    {
+        int64_t x;
+        int64_t y;
+        int64_t theta;
+
+        bool operator==(const Key& other) const
+        {
+            return x == other.x && y == other.y && theta == other.theta;
+        }
+    };
+
+    struct Slot
+    {
+        Slot() : generation(0) {}
+
+        Key key;
+        unsigned generation;
+        T value;
+    };
+
+    template<class Derived>
+    Key quantize(const Eigen::MatrixBase<Derived>& x) const
+    {
+        Key key;
+        key.x = std::floor(x(0) / resolution + 0.5);
+        key.y = std::floor(x(1) / resolution + 0.5);
+        key.theta = 0;
+
+        if(x.size() > 2)
+        {
+            key.theta = static_cast<int64_t>(std::floor(x(2) / binSize + 0.5)) % bins;
+            if(key.theta < 0)
+                key.theta += bins;
+        }
+
+        return key;
+    }
+
+    std::size_t hash(const Key& key) const
+    {
+        uint64_t h = key.x * 0x9e3779b97f4a7c15ULL;
+        h ^= key.y * 0xc2b2ae3d27d4eb4fULL + (h << 6) + (h >> 2);
+        h ^= key.theta * 0x165667b19e3779f9ULL + (h << 6) + (h >> 2);
+
+        return h ^ (h >> 29);
+    }
+
+    void grow()
+    {
+        std::vector<Slot> old(std::max<std::size_t>(64, 2 * slots.size()));
+        old.swap(slots);
+        mask = slots.size() - 1;
+
+        for(Slot& slot : old)
+        {
+            if(slot.generation != generation)
+                continue;
+
+            std::size_t i = hash(slot.key) & mask;
+            while(slots[i].generation == generation)
+                i = (i + 1) & mask;
+
+            slots[i].key = slot.key;
+            slots[i].generation = generation;
+            slots[i].value = std::move(slot.value);
+        }
+    }
+
+private:
+    double resolution;
+    int64_t bins;
+    double binSize;
+
+    std::vector<Slot> slots;
+    unsigned generation;
+    std::size_t count;
+    std::size_t mask;
+};
+
+}
+
+#endif // INCLUDE_RRT_PLANNING_NH_STATETABLE_H
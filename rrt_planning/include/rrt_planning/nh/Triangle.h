@@ -7,28 +7,50 @@ namespace rrt_planning
 {
   struct Triangle
   {
+    //Unaligned, so triangles can be stored in standard containers
+    typedef Eigen::Matrix<double, 2, 1, Eigen::DontAlign> Point;
+
     inline Triangle(){}
-    inline Triangle(const Eigen::VectorXd& a, const Eigen::VectorXd& b,
-      const Eigen::VectorXd& c): a(a), b(b), c(c)
+    inline Triangle(const Eigen::Vector2d& a, const Eigen::Vector2d& b,
+      const Eigen::Vector2d& c): a(a), b(b), c(c)
     {
         double magics = (-b(1) * c(0) + a(1) * (-b(0) + c(0)) + a(0) * (b(1) - c(1)) + b(0) * c(1));
         area = 0.5 * magics;
+
+        //Barycentric edge functions s(p) = s0 + sx*x + sy*y, t(p) = t0 + tx*x + ty*y,
+        //with the orientation sign folded in
+        int sign = area < 0 ? -1 : 1;
+        s0 = (a(1) * c(0) - a(0) * c(1)) * sign;
+        sx = (c(1) - a(1)) * sign;
+        sy = (a(0) - c(0)) * sign;
+        t0 = (a(0) * b(1) - a(1) * b(0)) * sign;
+        tx = (a(1) - b(1)) * sign;
+        ty = (b(0) - a(0)) * sign;
+        limit = 2 * area * sign;
     }
 
-    bool contains(const Eigen::VectorXd& p)
+    inline bool contains(double x, double y) const
     {
-        int sign = area < 0 ? -1 : 1;
-        double s = (a(1) * c(0) - a(0) * c(1) + (c(1) - a(1)) * p(0) + (a(0) - c(0)) * p(1)) * sign;
-        double t = (a(0) * b(1) - a(1) * b(0) + (a(1) - b(1)) * p(0) + (b(0) - a(0)) * p(1)) * sign;
+        double s = s0 + sx * x + sy * y;
+        double t = t0 + tx * x + ty * y;
 
-        return ((s > 0) && (t > 0) && ((s + t) < 2 * area * sign));
+        return ((s > 0) && (t > 0) && ((s + t) < limit));
     }
 
-    Eigen::VectorXd a;
-    Eigen::VectorXd b;
-    Eigen::VectorXd c;
+    inline bool contains(const Eigen::Vector2d& p) const
+    {
+        return contains(p(0), p(1));
+    }
+
+    Point a;
+    Point b;
+    Point c;
     double area;
 
+    double s0, sx, sy;
+    double t0, tx, ty;
+    double limit;
+
   };
 
 
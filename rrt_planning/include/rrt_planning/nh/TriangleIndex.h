@@ -0,0 +1,68 @@
+#ifndef INCLUDE_RRT_PLANNING_NH_TRIANGLEINDEX_H
+#define INCLUDE_RRT_PLANNING_NH_TRIANGLEINDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include "rrt_planning/nh/Triangle.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Triangles hashed on a uniform grid of square cells, each one listed in the
+ * cells covered by its bounding box. Triangles covering too many cells are
+ * kept apart and always tested, after their bounding box.
+ */
+class TriangleIndex
+{
+public:
+    explicit TriangleIndex(double cellSize = 1.0);
+
+    void insert(const Triangle& t);
+
+    //True if p lies strictly inside one of the triangles
+    bool contains(const Eigen::Vector2d& p) const;
+
+    void clear();
+
+    inline int size() const
+    {
+        return triangles.size();
+    }
+
+    inline void setCellSize(double size)
+    {
+        cellSize = size;
+    }
+
+private:
+    struct Entry
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        Triangle t;
+        Eigen::Vector2d min;
+        Eigen::Vector2d max;
+    };
+
+    static const int MAX_CELLS = 256;
+
+    bool contains(const Entry& e, const Eigen::Vector2d& p) const;
+    inline uint64_t key(int64_t x, int64_t y) const
+    {
+        return (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y);
+    }
+
+private:
+    double cellSize;
+    std::vector<Entry, Eigen::aligned_allocator<Entry> > triangles;
+    std::unordered_map<uint64_t, std::vector<int> > cells;
+    std::vector<int> large;
+};
+
+}
+
+#endif // INCLUDE_RRT_PLANNING_NH_TRIANGLEINDEX_H
@@ -0,0 +1,46 @@
+#ifndef INCLUDE_RRT_PLANNING_NH_TRIANGLESET_H
+#define INCLUDE_RRT_PLANNING_NH_TRIANGLESET_H
+
+#include <vector>
+#include <Eigen/Dense>
+#include "rrt_planning/nh/Triangle.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Small set of triangles, stored as arrays of edge coefficients so that a
+ * point is tested against a whole block of triangles in one vectorizable
+ * loop. A bounding box of the set rejects far away points first.
+ */
+class TriangleSet
+{
+public:
+    TriangleSet();
+
+    void insert(const Triangle& t);
+
+    //True if p lies strictly inside one of the triangles
+    bool contains(const Eigen::Vector2d& p) const;
+
+    void clear();
+
+    inline int size() const
+    {
+        return limit.size();
+    }
+
+private:
+    static const int BLOCK = 8;
+
+private:
+    std::vector<double> s0, sx, sy;
+    std::vector<double> t0, tx, ty;
+    std::vector<double> limit;
+
+    double minX, minY, maxX, maxY;
+};
+
+}
+
+#endif // INCLUDE_RRT_PLANNING_NH_TRIANGLESET_H
@@ -25,6 +25,7 @@
 #define INCLUDE_RRT_PLANNING_RRT_RRTINDEX_H_
 
 #include "rrt_planning/rrt/Cover_Tree.h"
+#include "rrt_planning/utils/Stats.h"
 
 namespace rrt_planning
 {
@@ -68,6 +69,7 @@ public:
 
     inline void insert(RRTNode* p)
     {
+        Stats::count(Stats::INDEX_INSERT);
         CoverTree<RRTCoverWrapper>::insert(RRTCoverWrapper(&dist, p));
     }
 
@@ -78,6 +80,9 @@ public:
 
     inline RRTNode* getNearestNeighbour(const Eigen::VectorXd& x)
     {
+        Stats::count(Stats::INDEX_NEAREST);
+        StatsTimer timer(Stats::INDEX_NEAREST_TIME);
+
         RRTNode tmp(nullptr, x);
         RRTCoverWrapper tmpWrapped(&dist, &tmp);
         auto result = CoverTree<RRTCoverWrapper>::kNearestNeighbors(tmpWrapped, 1);
@@ -87,6 +92,9 @@ public:
 
     inline std::vector<RRTNode*> getNearestNeighbours(const Eigen::VectorXd& x, int k)
     {
+        Stats::count(Stats::INDEX_NEAREST);
+        StatsTimer timer(Stats::INDEX_NEAREST_TIME);
+
         RRTNode tmp(nullptr, x);
         RRTCoverWrapper tmpWrapped(&dist, &tmp);
         auto result = CoverTree<RRTCoverWrapper>::kNearestNeighbors(tmpWrapped, k);
@@ -10,7 +10,7 @@ class FixedSampler : public SamplingPosition
     public:
         FixedSampler() {}
         FixedSampler(double deltaX) : deltaX(deltaX) {}
-        virtual Eigen::VectorXd sample(const Eigen::VectorXd& corner, bool cw) override;
+        virtual Eigen::Vector3d sample(const Eigen::Vector3d& corner, bool cw) override;
         virtual ~FixedSampler() {}
     private:
         double deltaX;
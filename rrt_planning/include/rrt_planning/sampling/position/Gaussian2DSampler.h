@@ -10,7 +10,7 @@ class Gaussian2DSampler : public SamplingPosition
     public:
         Gaussian2DSampler() {}
         Gaussian2DSampler(double lambda) : lambda(lambda) {}
-        virtual Eigen::VectorXd sample(const Eigen::VectorXd& corner, bool cw) override;
+        virtual Eigen::Vector3d sample(const Eigen::Vector3d& corner, bool cw) override;
         virtual ~Gaussian2DSampler() {}
     private:
         double lambda;
@@ -10,7 +10,7 @@ class LineGaussianSampler : public SamplingPosition
     public:
         LineGaussianSampler() {}
         LineGaussianSampler(double lambda) : lambda(lambda) {}
-        virtual Eigen::VectorXd sample(const Eigen::VectorXd& corner, bool cw) override;
+        virtual Eigen::Vector3d sample(const Eigen::Vector3d& corner, bool cw) override;
         virtual ~LineGaussianSampler() {}
     private:
         double lambda;
@@ -10,7 +10,7 @@ class SamplingPosition
 {
     public:
         SamplingPosition() {}
-        virtual Eigen::VectorXd sample(const Eigen::VectorXd& corner, bool cw) = 0;
+        virtual Eigen::Vector3d sample(const Eigen::Vector3d& corner, bool cw) = 0;
         virtual ~SamplingPosition() {}
 
 };
@@ -10,7 +10,7 @@ class Uniform2DSampler : public SamplingPosition
     public:
         Uniform2DSampler() {}
         Uniform2DSampler(double deltaX) : deltaX(deltaX) {}
-        virtual Eigen::VectorXd sample(const Eigen::VectorXd& corner, bool cw) override;
+        virtual Eigen::Vector3d sample(const Eigen::Vector3d& corner, bool cw) override;
         virtual ~Uniform2DSampler() {}
     private:
         double deltaX;
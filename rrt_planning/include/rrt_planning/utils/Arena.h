@@ -0,0 +1,76 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_UTILS_ARENA_H_
+#define INCLUDE_RRT_PLANNING_UTILS_ARENA_H_
+
+#include <cstddef>
+#include <deque>
+
+namespace rrt_planning
+{
+
+/*
+ * Objects handed out again after clear() instead of being destroyed, so that
+ * their own buffers are reused as well. The caller initializes each object
+ * it acquires.
+ */
+template<class T>
+class ObjectPool
+{
+public:
+    ObjectPool() : used(0)
+    {
+    }
+
+    T* acquire()
+    {
+        if(used == objects.size())
+            objects.emplace_back();
+
+        return &objects[used++];
+    }
+
+    void clear()
+    {
+        used = 0;
+    }
+
+    inline std::size_t size() const
+    {
+        return used;
+    }
+
+    inline std::size_t getCapacity() const
+    {
+        return objects.size();
+    }
+
+private:
+    std::deque<T> objects;
+    std::size_t used;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_UTILS_ARENA_H_ */
@@ -0,0 +1,213 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_UTILS_STATS_H_
+#define INCLUDE_RRT_PLANNING_UTILS_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+//Define RRT_PLANNING_NO_STATS to compile the instrumentation out
+#ifndef RRT_PLANNING_NO_STATS
+#define RRT_PLANNING_STATS
+#endif
+
+namespace rrt_planning
+{
+
+/*
+ * Hot path counters and timers. Every thread accumulates into its own
+ * instance, so counting is a plain increment of thread local memory.
+ * Planners collect the counters of each query with a StatsScope.
+ * Timers read the clock twice per call, so they run only after
+ * setTiming(true), while the counters are always collected.
+ */
+class Stats
+{
+public:
+    enum Counter
+    {
+        MAP_IS_FREE,
+        MAP_BATCH_POINTS,
+        MAP_RAY_STEPS,
+        MAP_CORRIDOR,
+        SG_COLLISION,
+        SG_CORNER,
+        SG_CACHE_HIT,
+        SG_CACHE_MISS,
+        EXTENDER_COMPUTE,
+        EXTENDER_LOS,
+        EXTENDER_STEER,
+        INDEX_INSERT,
+        INDEX_NEAREST,
+        OPEN_INSERT,
+        OPEN_POP,
+        COUNTERS
+    };
+
+    enum Timer
+    {
+        MAP_UPDATE_TIME,
+        SG_COLLISION_TIME,
+        SG_GEOMETRY_TIME,
+        EXTENDER_TIME,
+        INDEX_NEAREST_TIME,
+        TIMERS
+    };
+
+public:
+    //Trivial, so that the thread local instances need no initialization guard
+    Stats() = default;
+
+    void reset();
+    Stats& operator+=(const Stats& other);
+    void print(std::ostream& os) const;
+
+    inline uint64_t getCounter(Counter counter) const
+    {
+        return counters[counter];
+    }
+
+    //Seconds
+    inline double getTime(Timer timer) const
+    {
+        return times[timer];
+    }
+
+    static const char* getName(Counter counter);
+    static const char* getName(Timer timer);
+
+    static inline Stats& local()
+    {
+        static thread_local Stats stats;
+        return stats;
+    }
+
+    static inline void count(Counter counter, uint64_t n = 1)
+    {
+#ifdef RRT_PLANNING_STATS
+        local().counters[counter] += n;
+#endif
+    }
+
+    static inline void addTime(Timer timer, double seconds)
+    {
+#ifdef RRT_PLANNING_STATS
+        local().times[timer] += seconds;
+#endif
+    }
+
+    //Enables the timers of all the threads, off by default
+    static inline void setTiming(bool enabled)
+    {
+        timing().store(enabled, std::memory_order_relaxed);
+    }
+
+    static inline bool isTimingEnabled()
+    {
+        return timing().load(std::memory_order_relaxed);
+    }
+
+    //True while a StatsTimer of the thread runs on timer
+    static inline bool isTiming(Timer timer)
+    {
+        return (running() >> timer) & 1;
+    }
+
+private:
+    friend class StatsTimer;
+
+    //Timers running on the thread, one bit each. Apart from the instance,
+    //so that StatsScope does not reset it
+    static inline unsigned& running()
+    {
+        static thread_local unsigned timers;
+        return timers;
+    }
+
+    static inline std::atomic<bool>& timing()
+    {
+        static std::atomic<bool> enabled(false);
+        return enabled;
+    }
+
+private:
+    uint64_t counters[COUNTERS];
+    double times[TIMERS];
+};
+
+//Adds the lifetime of the object to a timer, if timing is enabled. A timer
+//already running on the thread, as in a nested call, is not counted twice
+class StatsTimer
+{
+public:
+#ifdef RRT_PLANNING_STATS
+    explicit StatsTimer(Stats::Timer timer)
+        : timer(timer), active(Stats::isTimingEnabled() && !Stats::isTiming(timer))
+    {
+        if(!active)
+            return;
+
+        Stats::running() |= 1u << timer;
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~StatsTimer()
+    {
+        if(!active)
+            return;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        Stats::addTime(timer, elapsed.count());
+        Stats::running() &= ~(1u << timer);
+    }
+
+private:
+    Stats::Timer timer;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+#else
+    explicit StatsTimer(Stats::Timer timer)
+    {
+    }
+#endif
+};
+
+//Collects into target what the thread counts during the lifetime of the object.
+//Nested scopes also add their counts to the enclosing one
+class StatsScope
+{
+public:
+    explicit StatsScope(Stats& target);
+    ~StatsScope();
+
+private:
+    Stats& target;
+    Stats outer;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_UTILS_STATS_H_ */
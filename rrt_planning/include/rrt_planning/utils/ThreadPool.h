@@ -0,0 +1,91 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_RRT_PLANNING_UTILS_THREADPOOL_H_
+#define INCLUDE_RRT_PLANNING_UTILS_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rrt_planning/utils/Stats.h"
+
+namespace rrt_planning
+{
+
+/*
+ * Fixed set of worker threads running index ranges. Each worker owns a
+ * queue of task indices and steals from the other queues when its own is
+ * empty. The calling thread works as worker 0, so a pool of size 1 runs
+ * everything inline. The counters of the workers are added to the Stats
+ * of the calling thread.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    //Calls body(task, worker) for every task in [0, n) and waits for all of
+    //them. Only the calling thread may submit work
+    void parallelFor(int n, const std::function<void(int, int)>& body);
+
+    inline int size() const
+    {
+        return queues.size();
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    void work(int worker);
+    bool runOne(int worker);
+    bool take(int worker, int& task);
+
+private:
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::vector<Stats> workerStats;
+
+    const std::function<void(int, int)>* body;
+    std::atomic<int> pending;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned round;
+    bool stop;
+};
+
+}
+
+#endif /* INCLUDE_RRT_PLANNING_UTILS_THREADPOOL_H_ */
@@ -67,6 +67,11 @@ std::vector<Eigen::VectorXd> AbstractPlanner::getFirstPath()
     return first_path;
 }
 
+const Stats& AbstractPlanner::getStats() const
+{
+    return stats;
+}
+
 
 void AbstractPlanner::computeRoughness(std::vector<Eigen::VectorXd>& path)
 {
@@ -17,18 +17,22 @@
 #include "rrt_planning/RRTStarPlanner.h"
 #include "rrt_planning/ThetaStarRRTPlanner.h"
 #include "rrt_planning/VoronoiRRTPlanner.h"
+#include "rrt_planning/map/MapLoader.h"
+#include "rrt_planning/map/MappedMap.h"
 
 
 using namespace rrt_planning;
 using namespace std;
 
 AbstractPlanner* getPlanner(const string& name, costmap_2d::Costmap2DROS* costmap_ros, const string& t);
+AbstractPlanner* getPlanner(const string& name, Map& map, const string& t);
 bool parse(const std::string& conf, geometry_msgs::PoseStamped& start_pose,
                          geometry_msgs::PoseStamped& goal_pose);
 void save(const std::string& filename, const std::string& conf, double t, double l, double r,
                         std::vector<Eigen::VectorXd> plan);
 
 void saveRRTStar(const std::string& filename, const std::string& conf, rrt_planning::AbstractPlanner* planner, double tmax);
+void saveStats(const std::string& filename, const std::string& conf, rrt_planning::AbstractPlanner* planner);
 
 int main(int argc, char** argv)
 {
@@ -44,11 +48,39 @@ int main(int argc, char** argv)
     ros::init(argc, argv, node_name);
     ros::NodeHandle private_nh("~/");
 
-    //Costmap inizialization magics
-    tf::TransformListener tf_(ros::Duration(10));
-    costmap_2d::Costmap2DROS* costmap_ros = new costmap_2d::Costmap2DROS("global_costmap", tf_);
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-    costmap_ros->pause();
+    //Headless mode, the map is loaded from disk without map server and costmap
+    string map_file;
+    private_nh.param("map_file", map_file, string(""));
+
+    tf::TransformListener* tf_ = nullptr;
+    costmap_2d::Costmap2DROS* costmap_ros = nullptr;
+    std::shared_ptr<Map> headless_map;
+
+    if(map_file.empty())
+    {
+        //Costmap inizialization magics
+        tf_ = new tf::TransformListener(ros::Duration(10));
+        costmap_ros = new costmap_2d::Costmap2DROS("global_costmap", *tf_);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        costmap_ros->pause();
+    }
+    else if(map_file.size() > 4 && map_file.compare(map_file.size() - 4, 4, ".map") == 0)
+    {
+        //Already converted and inflated by map_converter
+        headless_map = MappedMap::open(map_file);
+    }
+    else
+    {
+        vector<string> costmap_params;
+        private_nh.param("costmap_params", costmap_params, vector<string>());
+
+        MapLoader loader;
+        for(auto& file : costmap_params)
+            loader.loadCostmapParams(file);
+        loader.loadMap(map_file);
+
+        headless_map.reset(loader.createMap());
+    }
 
     //Convert start and goal
     geometry_msgs::PoseStamped start_pose, goal_pose;
@@ -64,8 +96,12 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    //The timers are saved with the stats of the query
+    Stats::setTiming(true);
+
     //Launch planner
-    AbstractPlanner* planner = getPlanner(planner_name, costmap_ros, deadline);
+    AbstractPlanner* planner = headless_map ? getPlanner(planner_name, *headless_map, deadline)
+                                            : getPlanner(planner_name, costmap_ros, deadline);
     bool result = planner->makePlan(start_pose, goal_pose, plan);
 
     double tmax = atof(deadline.c_str());
@@ -115,6 +151,8 @@ int main(int argc, char** argv)
         }
     }
 
+    saveStats(dir + node_name, conf, planner);
+
     private_nh.deleteParam("");
 	ROS_FATAL_STREAM(node_name + " plan found? " << result);
 
@@ -123,6 +161,8 @@ int main(int argc, char** argv)
         delete planner;
     if(costmap_ros)
         delete costmap_ros;
+    if(tf_)
+        delete tf_;
 
     return 0;
 }
@@ -227,6 +267,17 @@ void saveRRTStar(const std::string& filename, const std::string& conf, AbstractP
     fl.close();
 }
 
+void saveStats(const std::string& filename, const std::string& conf, AbstractPlanner* planner)
+{
+    std::ofstream f;
+    f.open(filename + string(".stats"));
+
+    f << "configuration " << conf << "\n";
+    planner->getStats().print(f);
+
+    f.close();
+}
+
 AbstractPlanner* getPlanner(const string& name, costmap_2d::Costmap2DROS* costmap_ros, const string& t)
 {
     chrono::duration<double> Tmax(stod(t));
@@ -266,3 +317,33 @@ AbstractPlanner* getPlanner(const string& name, costmap_2d::Costmap2DROS* costma
         exit(0);
     }
 }
+
+AbstractPlanner* getPlanner(const string& name, Map& map, const string& t)
+{
+    chrono::duration<double> Tmax(stod(t));
+    if(name == "nh")
+    {
+        NHPlanner* planner = new NHPlanner(string(""), map, Tmax);
+        return planner;
+    }
+    else if(name == "nh_l2")
+    {
+        NHPlannerL2* planner = new NHPlannerL2(string(""), map, Tmax);
+        return planner;
+    }
+    else if(name == "rrt")
+    {
+        RRTPlanner* planner = new RRTPlanner(string(""), map, Tmax);
+        return planner;
+    }
+    else if(name == "rrt_star")
+    {
+        RRTStarPlanner* planner = new RRTStarPlanner(string(""), map, Tmax);
+        return planner;
+    }
+    else
+    {
+        ROS_FATAL("Planner not available without costmap, aborting");
+        exit(0);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "rrt_planning/map/MapLoader.h"
+#include "rrt_planning/map/MappedMap.h"
+
+using namespace rrt_planning;
+using namespace std;
+
+/*
+ * Converts a map_server map to the memory mapped format:
+ *   map_converter <map.yaml> <output.map> [--clearance] [costmap_params.yaml ...]
+ */
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " <map.yaml> <output.map> [--clearance] [costmap_params.yaml ...]" << endl;
+        return 1;
+    }
+
+    string mapFile = argv[1];
+    string outputFile = argv[2];
+    bool clearance = false;
+
+    try
+    {
+        MapLoader loader;
+        for(int i = 3; i < argc; i++)
+        {
+            if(string(argv[i]) == "--clearance")
+                clearance = true;
+            else
+                loader.loadCostmapParams(argv[i]);
+        }
+
+        loader.loadMap(mapFile);
+
+        SnapshotMap* map = loader.createMap();
+        int sizeX = map->getSizeX();
+        int sizeY = map->getSizeY();
+
+        vector<float> clearanceField;
+        if(clearance)
+        {
+            map->enableClearance();
+            clearanceField.resize(static_cast<size_t>(sizeX) * sizeY);
+
+            Eigen::VectorXd p(2);
+            for(int y = 0; y < sizeY; y++)
+            {
+                for(int x = 0; x < sizeX; x++)
+                {
+                    p << map->getOriginX() + (x + 0.5) * map->getResolution(),
+                         map->getOriginY() + (y + 0.5) * map->getResolution();
+
+                    //Already rounded down by the map
+                    clearanceField[static_cast<size_t>(y) * sizeX + x] = map->getClearance(p);
+                }
+            }
+        }
+
+        MappedMap::write(outputFile, sizeX, sizeY, map->getResolution(), map->getOriginX(), map->getOriginY(),
+                         loader.getCosts().data(), clearance ? clearanceField.data() : nullptr);
+
+        delete map;
+    }
+    catch(const exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,1022 @@
+#include <visualization_msgs/Marker.h>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "rrt_planning/NHPlannerBase.h"
+
+#include "rrt_planning/extenders/MotionPrimitivesExtender.h"
+#include "rrt_planning/kinematics_models/DifferentialDrive.h"
+#include "rrt_planning/utils/RandomGenerator.h"
+
+using namespace Eigen;
+
+using namespace std;
+
+//Default Constructor
+namespace rrt_planning
+{
+
+template<class SteerPolicy, class Metric>
+NHPlannerBase<SteerPolicy, Metric>::NHPlannerBase()
+{
+    deltaX = 0;
+    deltaTheta = 0;
+    anytime = false;
+    epsilon = 1;
+    persistent = false;
+    contextValid = false;
+
+    rosmap = nullptr;
+    map = nullptr;
+    visibility = nullptr;
+    pool = nullptr;
+    l2thetadis = nullptr;
+
+}
+
+template<class SteerPolicy, class Metric>
+NHPlannerBase<SteerPolicy, Metric>::NHPlannerBase(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
+{
+    initialize(name, costmap_ros);
+}
+
+template<class SteerPolicy, class Metric>
+NHPlannerBase<SteerPolicy, Metric>::NHPlannerBase(std::string name, costmap_2d::Costmap2DROS* costmap_ros, std::chrono::duration<double> t)
+{
+    initialize(name, costmap_ros);
+    Tmax = t;
+}
+
+template<class SteerPolicy, class Metric>
+NHPlannerBase<SteerPolicy, Metric>::NHPlannerBase(std::string name, Map& map, std::chrono::duration<double> t)
+{
+    initialize(name, map);
+    Tmax = t;
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
+{
+    //Get parameters from ros parameter server
+    ros::NodeHandle private_nh("~/" + name);
+
+    mapFactory.initialize(private_nh, costmap_ros);
+    initialize(private_nh);
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::initialize(std::string name, Map& map)
+{
+    ros::NodeHandle private_nh("~/" + name);
+
+    mapFactory.initialize(private_nh, map);
+    initialize(private_nh);
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::initialize(ros::NodeHandle& private_nh)
+{
+    private_nh.param("deltaX", deltaX, 0.5);
+    private_nh.param("deltaTheta", deltaTheta, 0.5);
+    private_nh.param("k", k, 3);
+    private_nh.param("k_ancestors", k_ancestors, 1);
+
+    //Corners closer than deltaX are merged
+    index.setRadius(deltaX);
+    samples.resize(std::max(k, 1));
+
+    double closed_cell_size;
+    private_nh.param("closed_cell_size", closed_cell_size, 1.0);
+    global_closed.setCellSize(closed_cell_size);
+
+    //States closer than the resolutions are merged in the reached set
+    double state_resolution, state_angle_resolution;
+    private_nh.param("state_resolution", state_resolution, 0.01);
+    private_nh.param("state_angle_resolution", state_angle_resolution, 0.02);
+    reached.setResolution(state_resolution, state_angle_resolution);
+
+    bool visibility_heuristic;
+    private_nh.param("visibility_heuristic", visibility_heuristic, false);
+    private_nh.param("contour_tolerance", visibility_tolerance, 0.0);
+
+    private_nh.param("anytime", anytime, false);
+    private_nh.param("epsilon_start", epsilon_start, 3.0);
+    private_nh.param("epsilon_step", epsilon_step, 0.5);
+    if(anytime && (epsilon_start < 1 || epsilon_step <= 0))
+        throw std::runtime_error("Anytime mode needs epsilon_start >= 1 and epsilon_step > 0");
+
+    private_nh.param("persistent_context", persistent, false);
+    contextValid = false;
+
+    rosmap = &mapFactory.getMap();
+    map = new SGMap(*rosmap);
+    //The graph would be rebuilt for every plan on a map that cannot tell what changed
+    if(visibility_heuristic && !rosmap->reportsChanges())
+    {
+        ROS_WARN_STREAM("visibility_heuristic needs a map that reports its changes, "
+                        "as Mapped or incremental Snapshot, the heuristic is disabled");
+        visibility_heuristic = false;
+    }
+
+    visibility = visibility_heuristic ? new VisibilityGraph(*rosmap) : nullptr;
+    l2thetadis = new L2ThetaDistance();
+
+    map->initialize(private_nh);
+    extenderFactory.initialize(private_nh, *rosmap, *l2thetadis);
+    visualizer.initialize(private_nh);
+    angleFactory.initialize(private_nh);
+    positionFactory.initialize(private_nh);
+
+    int threads;
+    private_nh.param("threads", threads, 1);
+    pool = threads > 1 ? new ThreadPool(threads) : nullptr;
+    for(int i = 1; i < threads; i++)
+    {
+        ExtenderFactory* factory = new ExtenderFactory();
+        factory->initialize(private_nh, *rosmap, *l2thetadis);
+        workerExtenders.push_back(factory);
+    }
+
+    double t;
+    private_nh.param("Tmax", t, 300.0);
+    Tmax = std::chrono::duration<double>(t);
+}
+
+template<class SteerPolicy, class Metric>
+bool NHPlannerBase<SteerPolicy, Metric>::makePlan(const geometry_msgs::PoseStamped& start_pose,
+                                   const geometry_msgs::PoseStamped& goal_pose,
+                                   std::vector<geometry_msgs::PoseStamped>& plan)
+{
+    StatsScope statsScope(stats);
+
+    bool found = search(start_pose, goal_pose, plan);
+    release();
+
+    return found;
+}
+
+template<class SteerPolicy, class Metric>
+bool NHPlannerBase<SteerPolicy, Metric>::search(const geometry_msgs::PoseStamped& start_pose,
+                        const geometry_msgs::PoseStamped& goal_pose,
+                        std::vector<geometry_msgs::PoseStamped>& plan)
+{
+    count = 0;
+
+#ifdef VIS_CONF
+    visualizer.clean();
+#endif
+    rosmap->update();
+    map->update();
+
+    x0 = convertPose(start_pose);
+    xGoal = convertPose(goal_pose);
+
+    if(!rosmap->isFree(x0))
+    {
+#ifdef PRINT_CONF
+      ROS_FATAL("Invalid starting position");
+#endif
+      return false;
+    }
+
+    if(!rosmap->isFree(xGoal))
+    {
+#ifdef PRINT_CONF
+      ROS_FATAL("Invalid goal position");
+#endif
+      return false;
+    }
+
+    if(visibility)
+    {
+        visibility->update(visibility_tolerance);
+        visibility->setGoal(xGoal.head<2>());
+    }
+
+    prepareContext(xGoal);
+
+    //Initialization
+    Node* start_node = nodes.acquire();
+    start_node->initialize(x0, nullptr, 0);
+    start_node->setParent(start_node);
+    length = 0;
+    roughness = 0;
+    epsilon = anytime ? epsilon_start : 1;
+    double bestCost = std::numeric_limits<double>::infinity();
+
+    //The goal action is the first of the pool and its own parent
+    target = Action(xGoal, true, true, false, 0);
+    actionPool.push_back(target);
+
+    addOpen(start_node, target);
+    start_node->addSubgoal(xGoal);
+    reached[x0] = start_node;
+
+    index.clear();
+    index.insert(xGoal);
+    for(auto& corner : corners)
+    {
+        index.insert(corner);
+    }
+#ifdef PRINT_CONF
+    ROS_FATAL("Start Search: pick a god and pray");
+#endif
+    ros::Time start_time = ros::Time::now();
+    t0 = chrono::steady_clock::now();
+
+    //The last plan joined to the new start bounds the search, or ends it
+    Node* reused = reusePlan(start_node);
+    if(reused)
+    {
+        bestCost = reused->getCost();
+        recordPlan(reused, plan, start_pose.header.stamp, true);
+#ifdef PRINT_CONF
+        ROS_FATAL("Plan found: last plan reused");
+#endif
+        if(!anytime)
+            return true;
+    }
+
+    //Start search
+    while(!open.empty() && !timeOut())
+    {
+        Key key = open.pop();
+        Node* current = key.first;
+        Action action = key.second;
+
+        //Nothing past the current plan can improve it
+        if(!std::isinf(bestCost) && current->getCost() + estimate(current, action) >= bestCost)
+        {
+            continue;
+        }
+
+        //Check if the goal is reached
+        if(isReached(current->getState(), xGoal))
+        {
+            bool first = std::isinf(bestCost);
+            bestCost = current->getCost();
+            recordPlan(current, plan, start_pose.header.stamp, first);
+#ifdef PRINT_CONF
+            ROS_FATAL("Plan found: simple geometry");
+#endif
+#ifdef DEBUG_CONF
+            ROS_FATAL_STREAM("Action count: " << count);
+            ROS_FATAL_STREAM("Epsilon: " << epsilon);
+            ROS_FATAL_STREAM("New time: " << Tcurrent.count());
+            ROS_FATAL_STREAM("Path length: " << getPathLength());
+            ROS_FATAL_STREAM("Roughness: " << getRoughness());
+#endif
+            if(!anytime)
+                return true;
+
+            //Tighten the bound and go on with the same open list and closed areas
+            if(epsilon > 1)
+            {
+                epsilon = std::max(1.0, epsilon - epsilon_step);
+                open.rebuild([&](const Key& k)
+                {
+                    return k.first->getCost() + epsilon * estimate(k.first, k.second);
+                });
+            }
+
+            continue;
+        }
+
+        Node* new_node = nullptr;
+        int n = 0;
+        double theta = action.getState()(2);
+        bool improve = true;
+
+        //The samples of the action are the first n of the buffer
+        if(action.getState() == xGoal)
+        {
+            samples[0] = xGoal;
+            n = 1;
+        }
+        else if(action.isCorner())
+        {
+            const Vector3d& xState = current->getState();
+            const Vector3d& xCorner = action.getState();
+            const vector<VectorXd>* known = corner_samples.find(xCorner.head<2>());
+
+            if(known)
+            {
+                n = known->size();
+                if(samples.size() < n)
+                    samples.resize(n);
+
+                for(int i = 0; i < n; i++)
+                    samples[i] = (*known)[i];
+            } else
+            {
+                samples[0] = xCorner;
+                n = 1;
+            }
+
+            theta = atan2(xCorner(1) - xState(1), xCorner(0) - xState(0));
+        }
+
+        //Angles are drawn in sample order, then the rollouts are merged in the same order
+        for(int i = 0; i < n; i++)
+        {
+            if(samples[i] != xGoal)
+            {
+                samples[i](2) = sampleAngle(theta);
+            }
+        }
+
+        reach(current, samples, n);
+
+        for(int i = 0; i < n; i++)
+        {
+            new_node = createNode(current, i);
+            if(new_node)
+            {
+                //If I can reach it, see if I already passed it or if it's the Goal
+                Node** known = reached.find(new_node->getState());
+                if(!known)
+                {
+                    reached[new_node->getState()] = new_node;
+                    addOpen(new_node, target);
+                    new_node->addSubgoal(xGoal);
+                }
+                else if(anytime && new_node->getCost() < (*known)->getCost())
+                {
+                    //Cheaper way to a reached state, open it again as ARA* does
+                    *known = new_node;
+                    addOpen(new_node, target);
+                    new_node->addSubgoal(xGoal);
+                }
+                  else
+                {
+                    new_node = *known;
+                }
+#ifdef VIS_CONF
+                visualizer.addSegment(current->getState(), new_node->getState());
+#endif
+                Action p = actionPool[action.getParent()];
+                if(!new_node->contains(p.getState()))
+                {
+                    Action parent(p.getState(), p.isClockwise(), true,
+                                        p.isCorner(), p.getParent());
+                    addOpen(new_node, parent);
+                    new_node->addSubgoal(parent.getState());
+                }
+                improve = false;
+            }
+
+        }
+
+        //Couldn't reach the corner or it is not valid, improve it
+        if(improve)
+        {
+            findAction(current, action, newActions, triangles);
+            for(const auto& a : newActions)
+            {
+
+                if(fabs(current->getState()(2)) < 2*M_PI && a.getState() != action.getState())
+                {
+                    count++;
+                    addOpen(current, a);
+
+                    if(a.isCorner())
+                    {
+                        Action copy = a;
+                        Vector3d curr = a.getState();
+                        Vector3d nearest;
+                        if(index.findNearest(curr, nearest))
+                        {
+                            copy.setState(nearest);
+                        }
+                        else
+                        {
+                            index.insert(curr);
+                            corners.push_back(curr);
+                            const Vector3d& x = current->getState();
+                            double theta = atan2(curr(1)- x(1), curr(0) - x(0));
+                            curr(2) = theta;
+                            sampleCorner(curr, a.isClockwise());
+                        }
+
+                        addSubgoal(current, copy);
+#ifdef VIS_CONF
+                        visualizer.addCorner(copy.getState());
+#endif
+                    }
+#ifdef VIS_CONF
+                    else
+                        visualizer.addPoint(a.getState());
+#endif
+                }
+            }
+
+            for(const auto& t : triangles)
+            {
+                current->addTriangle(t);
+            }
+        }
+        else
+        {
+            Action p = actionPool[action.getParent()];
+            addGlobal(current->getState(), action.getState(), p.getState());
+            current->addSubgoal(action.getState());
+        }
+    }
+#ifdef VIS_CONF
+    visualizer.flush();
+#endif
+
+    //Anytime mode, the last plan found is the best one
+    if(!std::isinf(bestCost))
+        return true;
+
+#ifdef PRINT_CONF
+    ROS_FATAL("Failed to find plan: omae wa mou shindeiru");
+#endif
+    Tcurrent = chrono::steady_clock::now() - t0;
+
+    return false;
+
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::release()
+{
+    open.clear();
+    reached.clear();
+    global_closed.clear();
+    target = Action();
+
+    //The corners and the last plan stay for the next query on the same goal
+    if(!persistent)
+        resetContext();
+
+    //No node or action of the query is referenced anymore
+    nodes.clear();
+    actionPool.clear();
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::prepareContext(const Vector3d& xGoal)
+{
+    Bounds changed;
+    bool known = rosmap->getChangedBounds(changed);
+
+    if(!persistent || !contextValid || !known || xGoal != contextGoal)
+    {
+        resetContext();
+    }
+    else if(changed.minX < changed.maxX && changed.minY < changed.maxY)
+    {
+        //Forget what was found near the changed cells
+        Vector2d min(changed.minX - deltaX, changed.minY - deltaX);
+        Vector2d max(changed.maxX + deltaX, changed.maxY + deltaX);
+        auto inside = [&](const Ref<const VectorXd>& p)
+        {
+            return p(0) >= min(0) && p(1) >= min(1) && p(0) <= max(0) && p(1) <= max(1);
+        };
+        auto changedCorner = [&](const Vector2d& corner, const vector<VectorXd>& samples)
+        {
+            return inside(corner) || std::any_of(samples.begin(), samples.end(), inside);
+        };
+
+        corners.erase(std::remove_if(corners.begin(), corners.end(), [&](const Vector3d& corner)
+        {
+            const vector<VectorXd>* samples = corner_samples.find(corner.head<2>());
+            return inside(corner) || (samples && changedCorner(corner.head<2>(), *samples));
+        }), corners.end());
+        corner_samples.removeIf(changedCorner);
+
+        for(const auto& w : solution)
+        {
+            if(inside(w.state) || std::any_of(w.mp.begin(), w.mp.end(), inside))
+            {
+                solution.clear();
+                break;
+            }
+        }
+    }
+
+    contextGoal = xGoal;
+    contextValid = persistent;
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::resetContext()
+{
+    corner_samples.clear();
+    corners.clear();
+    solution.clear();
+    contextValid = false;
+}
+
+template<class SteerPolicy, class Metric>
+Node* NHPlannerBase<SteerPolicy, Metric>::reusePlan(Node* start_node)
+{
+    if(solution.empty())
+        return nullptr;
+
+    //Skip the nodes the start has already passed
+    const Vector3d& x0 = start_node->getState();
+    int nearest = 0;
+    for(int i = 1; i < solution.size(); i++)
+    {
+        if((solution[i].state - x0).template head<2>().squaredNorm() <
+           (solution[nearest].state - x0).template head<2>().squaredNorm())
+            nearest = i;
+    }
+
+    //Join the start to the first of the next nodes it reaches, the rest of the plan is kept
+    for(int i = std::max(1, nearest); i < solution.size(); i++)
+    {
+        samples[0] = solution[i].state;
+        reach(start_node, samples, 1);
+
+        Rollout& r = rollouts[0];
+        if(!r.valid || !isReached(r.xNew, solution[i].state))
+            continue;
+
+        //The rollout ends within the tolerance of the node, which keeps its state
+        //so that plans joined again and again do not drift
+        Node* node = nodes.acquire();
+        node->initialize(solution[i].state, start_node, r.cost + metric(r.xNew, solution[i].state));
+        node->setMotionPrimitives(r.parents);
+        double offset = node->getCost() - solution[i].cost;
+        reached[node->getState()] = node;
+
+        for(int j = i + 1; j < solution.size(); j++)
+        {
+            Node* next = nodes.acquire();
+            next->initialize(solution[j].state, node, solution[j].cost + offset);
+            next->setMotionPrimitives(solution[j].mp);
+            reached[next->getState()] = next;
+            node = next;
+        }
+
+        return node;
+    }
+
+    return nullptr;
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::recordPlan(Node* node, std::vector<geometry_msgs::PoseStamped>& plan,
+                            const ros::Time& stamp, bool first)
+{
+    retrievePath(node, final_path);
+    plan.clear();
+    publishPlan(final_path, plan, stamp);
+#ifdef VIS_CONF
+    visualizer.displayPlan(plan);
+    visualizer.flush();
+#endif
+    computeRoughness(final_path);
+    if(first)
+    {
+        Tcurrent = chrono::steady_clock::now() - t0;
+        first_path = final_path;
+        first_length = length;
+        first_roughness = roughness;
+    }
+
+    if(!persistent)
+        return;
+
+    //Keep the nodes of the plan, from the start to the goal
+    int n = 0;
+    for(Node* current = node; current->getCost() != 0; current = current->getParent())
+        n++;
+
+    solution.resize(n + 1);
+    for(Node* current = node; n >= 0; current = current->getParent(), n--)
+    {
+        solution[n].state = current->getState();
+        solution[n].cost = current->getCost();
+        solution[n].mp = current->getMotionPrimitives();
+    }
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::reach(Node* current, const vector<VectorXd>& targets, int n)
+{
+    xCurr = current->getState();
+    double cost = current->getCost();
+
+    if(rollouts.size() < n)
+        rollouts.resize(n);
+
+    auto run = [&](int i, int worker)
+    {
+        Extender& extender = (worker == 0) ? extenderFactory.getExtender()
+                                           : workerExtenders[worker - 1]->getExtender();
+        Rollout& rollout = rollouts[i];
+        rollout.xNew = xCurr;
+        rollout.parents.clear();
+        rollout.cost = cost;
+        rollout.valid = steer(extender, xCurr, targets[i], rollout.xNew, rollout.parents, rollout.cost);
+    };
+
+    if(pool)
+    {
+        pool->parallelFor(n, run);
+    }
+    else
+    {
+        for(int i = 0; i < n; i++)
+            run(i, 0);
+    }
+}
+
+template<class SteerPolicy, class Metric>
+Node* NHPlannerBase<SteerPolicy, Metric>::createNode(Node* current, int rollout)
+{
+    Rollout& r = rollouts[rollout];
+
+    Node* new_node = nullptr;
+    if(r.valid)
+    {
+        r.parents.pop_back();
+        new_node = nodes.acquire();
+        new_node->initialize(r.xNew, current, r.cost);
+        new_node->setMotionPrimitives(r.parents);
+    }
+    return new_node;
+}
+
+template<class SteerPolicy, class Metric>
+bool NHPlannerBase<SteerPolicy, Metric>::isReached(const Vector3d& x0, const Vector3d& xTarget)
+{
+    return ((metric(x0, xTarget) < deltaX) && (angle(x0, xTarget) < deltaTheta));
+}
+
+template<class SteerPolicy, class Metric>
+Vector3d NHPlannerBase<SteerPolicy, Metric>::convertPose(const geometry_msgs::PoseStamped& msg)
+{
+    auto& q_ros = msg.pose.orientation;
+    auto& t_ros = msg.pose.position;
+
+    Quaterniond q(q_ros.w, q_ros.x, q_ros.y, q_ros.z);
+
+    Vector3d theta = q.matrix().eulerAngles(0, 1, 2);
+
+    Vector3d x;
+    x << t_ros.x, t_ros.y, theta(2);
+
+    return x;
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::publishPlan(std::vector<VectorXd>& path,
+                                      std::vector<geometry_msgs::PoseStamped>& plan, const ros::Time& stamp)
+{
+    for(const auto& x : path)
+    {
+        geometry_msgs::PoseStamped msg;
+
+        msg.header.stamp = stamp;
+        msg.header.frame_id = "map";
+
+        msg.pose.position.x = x(0);
+        msg.pose.position.y = x(1);
+        msg.pose.position.z = 0;
+
+        Matrix3d m;
+        m = AngleAxisd(x(2), Vector3d::UnitZ())
+            * AngleAxisd(0, Vector3d::UnitY())
+            * AngleAxisd(0, Vector3d::UnitX());
+
+        Quaterniond q(m);
+
+        msg.pose.orientation.x = q.x();
+        msg.pose.orientation.y = q.y();
+        msg.pose.orientation.z = q.z();
+        msg.pose.orientation.w = q.w();
+
+        plan.push_back(msg);
+    }
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::addOpen(Node* node, const Action& action)
+{
+
+    if((action.getState() !=  target.getState()) && insideGlobal(action.getState(), action.isSubgoal()))
+    {
+
+    	return;
+    }
+
+   if(node->insideArea(action.getState()))
+    {
+
+    	return;
+    }
+
+    Key key(node, action);
+    double h = estimate(node, action);
+    open.insert(key, epsilon * h + node->getCost());
+
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::addSubgoal(Node* node, const Action& action)
+{
+
+    Action subgoal(action.getState(), action.isClockwise(), true, action.isCorner(), action.getParent());
+    Node* parent = node->getParent();
+    int j = 0;
+    if(insideGlobal(action.getState(), action.isSubgoal()))
+    {
+
+        return;
+    }
+
+    while(!parent->contains(subgoal.getState()) && j < k_ancestors)
+    {
+        if(!parent->insideArea(subgoal.getState()))
+        {
+            Key key(parent, subgoal);
+            double h = estimate(parent, subgoal);
+            open.insert(key, epsilon * h + parent->getCost());
+        }
+        parent->addSubgoal(subgoal.getState());
+        parent = parent->getParent();
+        j++;
+    }
+
+}
+
+template<class SteerPolicy, class Metric>
+double NHPlannerBase<SteerPolicy, Metric>::heuristic(const Vector3d& x)
+{
+    //Shortest path around the obstacles, when the goal can be reached from x
+    if(visibility)
+    {
+        double h = visibility->distance(x.head<2>());
+        if(!std::isinf(h))
+            return h;
+    }
+
+    return metric(x, target.getState());
+}
+
+template<class SteerPolicy, class Metric>
+double NHPlannerBase<SteerPolicy, Metric>::estimate(Node* node, const Action& action)
+{
+    return metric(node->getState(), action.getState()) + heuristic(action.getState());
+}
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::findAction(Node* node, const Action& action, vector<Action>& actions,
+                                                    vector<Triangle>& triangles)
+{
+    xNode = node->getState();
+    xAction = action.getState();
+    const VectorXd& n = xNode;
+    const VectorXd& a = xAction;
+    Vector3d vertices[2];
+    int found = 0;
+    //FIXME use parameters
+    double step = 0.3;
+    bool follow = false;
+
+    actions.clear();
+    triangles.clear();
+    bool is_los = map->collisionPoints(a, n, collision);
+
+    if(is_los)
+    {
+        triangles.push_back(createTriangle(action, n));
+
+        is_los = map->followObstacle(n, a, collision);
+        if(is_los){
+            actions.push_back(Action(collision[0], action.isClockwise(), false, true, action.getParent()));
+            return;
+        }
+        follow = true;
+    }
+
+    if(is_los || collision.size() < 2) {return;}
+
+    double c1 = metric(collision[0], a);
+    double c2 = metric(collision[1], a);
+    bool sample = action.isSubgoal();
+    if(!follow && c1 > step && c2 > step) {sample = true;}
+    if(!is_los) {swap(collision[0], collision[1]);}
+
+    VectorXd middle = map->computeMiddle(collision[0], collision[1]);
+
+    if(action.isClockwise() || sample)
+    {
+        VectorXd new_state = map->exitPoint(n, middle, true);
+        vertices[found++] = new_state;
+        if(rosmap->insideBound(new_state))
+        {
+            int p = action.getParent();
+            bool corner = map->isCorner(new_state);
+            if(sample)
+            {
+                p = actionPool.size();
+                actionPool.push_back(action);
+            }
+
+            actions.push_back(Action(new_state, true, false, corner, p));
+        }
+    }
+
+    if(!action.isClockwise() || sample)
+    {
+        VectorXd new_state = map->exitPoint(n, middle, false);
+        vertices[found++] = new_state;
+        if(rosmap->insideBound(new_state))
+        {
+            int p = action.getParent();
+            bool corner = map->isCorner(new_state);
+            if(sample)
+            {
+                p = actionPool.size();
+                actionPool.push_back(action);
+            }
+            actions.push_back(Action(new_state, false, false, corner, p));
+        }
+    }
+
+
+    if(sample && found == 2 && vertices[0] != vertices[1])
+    {
+        Triangle t(a.head<2>(), vertices[0].head<2>(), vertices[1].head<2>());
+        triangles.push_back(t);
+    }
+  }
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::addGlobal(const Vector3d& node, const Vector3d& action, const Vector3d& parent)
+{
+    xNode = node;
+    xAction = action;
+    xParent = parent;
+
+    //check los(node, action)
+    bool is_los = map->collisionPoints(xNode, xAction, collision);
+    if(!is_los && metric(collision[1], action) > deltaX)
+    {
+        return;
+    }
+
+    //check los(node, parent)
+    is_los = map->collisionPoints(xNode, xParent, collision);
+    Vector3d p = parent;
+    if(collision.size() == 2)
+    {
+        p = map->computeMiddle(collision[0], collision[1]);
+    }
+
+    //TODO check los(action, parent)
+
+    Triangle t(node.head<2>(), action.head<2>(), p.head<2>());
+    global_closed.insert(t);
+}
+
+template<class SteerPolicy, class Metric>
+bool NHPlannerBase<SteerPolicy, Metric>::insideGlobal(const Eigen::Vector3d& p, bool subgoal)
+{
+    return global_closed.contains(p.head<2>());
+}
+
+template<class SteerPolicy, class Metric>
+Triangle NHPlannerBase<SteerPolicy, Metric>::createTriangle(const Action& action, const Eigen::VectorXd& n)
+{
+    xParent = actionPool[action.getParent()].getState();
+    bool dummy = map->collisionPoints(n, xParent, parentCollision);
+    Vector3d p = xParent;
+    if(parentCollision.size() == 2)
+    {
+        p = map->computeMiddle(parentCollision[0], parentCollision[1]);
+    }
+    return Triangle(action.getState().head<2>(), n.head<2>(), p.head<2>());
+}
+
+/*void NHPlannerBase<SteerPolicy, Metric>::sampleCorner(const VectorXd& corner, bool cw)
+{
+    vector<VectorXd> samples;
+    VectorXd sample = positionFactory.getSampling().sample(corner, cw);
+    if(rosmap->isFree(sample))
+    {
+        samples.push_back(sample);
+        //visualizer.addCorner(sample);
+        corner_samples[Vector2d(corner(0), corner(1))] = samples;
+        return;
+    }
+
+    sample = positionFactory.getSampling().sample(corner, !cw);
+    if(rosmap->isFree(sample))
+    {
+        samples.push_back(sample);
+        //visualizer.addCorner(sample);
+        corner_samples[Vector2d(corner(0), corner(1))] = samples;
+        return;
+    }
+    corner_samples[Vector2d(corner(0), corner(1))] = samples;
+    samples.push_back(corner);
+    /*while(samples.size() < k)
+    {
+        VectorXd sample = positionFactory.getSampling().sample(corner, cw);
+        if(rosmap->isFree(sample))
+        {
+            samples.push_back(sample);
+            visualizer.addCorner(sample);
+        }
+    }
+
+    return;
+}*/
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::sampleCorner(const Vector3d& corner, bool cw)
+{
+    //A recycled entry keeps the samples of an old corner, they are overwritten
+    vector<VectorXd>& values = corner_samples[corner.head<2>()];
+    values.resize(k);
+
+    int n = 0;
+    while(n < k)
+    {
+        values[n] = positionFactory.getSampling().sample(corner, cw);
+        if(rosmap->isFree(values[n]))
+        {
+#ifdef VIS_CONF
+            visualizer.addCorner(values[n]);
+#endif
+            n++;
+        }
+    }
+
+    return;
+}
+
+template<class SteerPolicy, class Metric>
+double NHPlannerBase<SteerPolicy, Metric>::sampleAngle(double theta)
+{
+    return (angleFactory.getSampling().sample() + theta);
+}
+
+
+template<class SteerPolicy, class Metric>
+void NHPlannerBase<SteerPolicy, Metric>::retrievePath(Node* node, vector<VectorXd>& path)
+{
+    Node* current = node;
+    length = current->getCost();
+
+    //Written backwards in place, so that the states of the path are reused
+    int size = 1;
+    for(Node* n = node; n->getCost() != 0; n = n->getParent())
+        size += 1 + n->getMotionPrimitives().size();
+
+    path.resize(size);
+    int i = size - 1;
+
+    while(current->getCost() != 0)
+    {
+#ifdef VIS_CONF
+        visualizer.addPathPoint(current->getState());
+#endif
+        path[i--] = current->getState();
+        const vector<Vector3d>& mp = current->getMotionPrimitives();
+        for(auto m = mp.rbegin(); m != mp.rend(); ++m)
+        {
+            path[i--] = *m;
+        }
+        current = current->getParent();
+    }
+
+    path[i] = current->getState();
+}
+
+template<class SteerPolicy, class Metric>
+NHPlannerBase<SteerPolicy, Metric>::~NHPlannerBase()
+{
+    if(l2thetadis)
+        delete l2thetadis;
+
+    if(map)
+        delete map;
+
+    if(visibility)
+        delete visibility;
+
+    if(pool)
+        delete pool;
+
+    for(ExtenderFactory* factory : workerExtenders)
+        delete factory;
+}
+
+//The NH planners
+template class NHPlannerBase<Steer, L2Metric>;
+template class NHPlannerBase<SteerL2, L2Metric>;
+
+}
@@ -26,7 +26,6 @@
 
 #include "rrt_planning/RRTPlanner.h"
 
-#include "rrt_planning/map/ROSMap.h"
 #include "rrt_planning/kinematics_models/DifferentialDrive.h"
 #include "rrt_planning/extenders/MotionPrimitivesExtender.h"
 #include "rrt_planning/utils/RandomGenerator.h"
@@ -64,19 +63,39 @@ RRTPlanner::RRTPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros,
     Tmax = t;
 }
 
+RRTPlanner::RRTPlanner(std::string name, Map& map, std::chrono::duration<double> t)
+{
+    initialize(name, map);
+    Tmax = t;
+}
+
 
 void RRTPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
 {
-    map = new ROSMap(costmap_ros);
-    distance = new L2ThetaDistance();
-
     //Get parameters from ros parameter server
     ros::NodeHandle private_nh("~/" + name);
 
+    mapFactory.initialize(private_nh, costmap_ros);
+    initialize(private_nh);
+}
+
+void RRTPlanner::initialize(std::string name, Map& map)
+{
+    ros::NodeHandle private_nh("~/" + name);
+
+    mapFactory.initialize(private_nh, map);
+    initialize(private_nh);
+}
+
+void RRTPlanner::initialize(ros::NodeHandle& private_nh)
+{
+    distance = new L2ThetaDistance();
+
     private_nh.param("iterations", K, 30000);
     private_nh.param("deltaX", deltaX, 0.5);
     private_nh.param("greedy", greedy, 0.1);
 
+    map = &mapFactory.getMap();
 
     extenderFactory.initialize(private_nh, *map, *distance);
     visualizer.initialize(private_nh);
@@ -90,6 +109,9 @@ bool RRTPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                           const geometry_msgs::PoseStamped& goal,
                           std::vector<geometry_msgs::PoseStamped>& plan)
 {
+    StatsScope statsScope(stats);
+
+    map->update();
     Distance& distance = *this->distance;
 
     VectorXd&& x0 = convertPose(start);
@@ -227,9 +249,6 @@ RRTPlanner::~RRTPlanner()
     if(distance)
         delete distance;
 
-    if(map)
-        delete map;
-
 }
 
 
@@ -3,7 +3,6 @@
 
 #include "rrt_planning/RRTStarPlanner.h"
 
-#include "rrt_planning/map/ROSMap.h"
 #include "rrt_planning/kinematics_models/DifferentialDrive.h"
 #include "rrt_planning/extenders/MotionPrimitivesExtender.h"
 #include "rrt_planning/utils/RandomGenerator.h"
@@ -47,15 +46,34 @@ RRTStarPlanner::RRTStarPlanner(std::string name, costmap_2d::Costmap2DROS* costm
     Tmax = t;
 }
 
+RRTStarPlanner::RRTStarPlanner(std::string name, Map& map, std::chrono::duration<double> t)
+{
+    initialize(name, map);
+    Tmax = t;
+}
+
 
 void RRTStarPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
 {
-    map = new ROSMap(costmap_ros);
-    distance = new L2ThetaDistance();
-
     //Get parameters from ros parameter server
     ros::NodeHandle private_nh("~/" + name);
 
+    mapFactory.initialize(private_nh, costmap_ros);
+    initialize(private_nh);
+}
+
+void RRTStarPlanner::initialize(std::string name, Map& map)
+{
+    ros::NodeHandle private_nh("~/" + name);
+
+    mapFactory.initialize(private_nh, map);
+    initialize(private_nh);
+}
+
+void RRTStarPlanner::initialize(ros::NodeHandle& private_nh)
+{
+    distance = new L2ThetaDistance();
+
     private_nh.param("K", K, 1);
     private_nh.param("deltaX", deltaX, 0.5);
     private_nh.param("greedy", greedy, 0.1);
@@ -63,6 +81,8 @@ void RRTStarPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* cost
     private_nh.param("dimension", dimension, 3);
     private_nh.param("knn", knn, 20);
 
+    map = &mapFactory.getMap();
+
     extenderFactory.initialize(private_nh, *map, *distance);
     visualizer.initialize(private_nh);
     //gamma = pow(2.0,4.0)*exp(1.0 + 1.0/3.0);
@@ -75,6 +95,9 @@ bool RRTStarPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                           const geometry_msgs::PoseStamped& goal,
                           std::vector<geometry_msgs::PoseStamped>& plan)
 {
+    StatsScope statsScope(stats);
+
+    map->update();
     Distance& distance = *this->distance;
 
     VectorXd&& x0 = convertPose(start);
@@ -333,9 +356,6 @@ RRTStarPlanner::~RRTStarPlanner()
     if(distance)
         delete distance;
 
-    if(map)
-        delete map;
-
 }
 
 
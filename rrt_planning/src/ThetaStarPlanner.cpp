@@ -62,7 +62,8 @@ void ThetaStarPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* co
     private_nh.param("discretization", discretization, 0.2);
     pub = private_nh.advertise<visualization_msgs::Marker>("/visualization_marker", 1);
 
-    map = new ROSMap(costmap_ros);
+    mapFactory.initialize(private_nh, costmap_ros);
+    map = &mapFactory.getMap();
     grid = new Grid(*map, discretization);
 
     visualizer.initialize(private_nh);
@@ -73,6 +74,7 @@ bool ThetaStarPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                                 std::vector<geometry_msgs::PoseStamped>& plan)
 {
     clearInstance();
+    map->update();
 #ifdef VIS_CONF
     visualizer.clean();
 #endif
@@ -452,8 +454,6 @@ ThetaStarPlanner::~ThetaStarPlanner()
     if(grid)
         delete grid;
 
-    if(map)
-        delete map;
 }
 
 
@@ -27,7 +27,6 @@
 #include "rrt_planning/ThetaStarRRTPlanner.h"
 
 #include "rrt_planning/extenders/MotionPrimitivesExtender.h"
-#include "rrt_planning/map/ROSMap.h"
 #include "rrt_planning/kinematics_models/DifferentialDrive.h"
 #include "rrt_planning/utils/RandomGenerator.h"
 #include "rrt_planning/rrt/RRT.h"
@@ -75,7 +74,6 @@ void ThetaStarRRTPlanner::initialize(std::string name, costmap_2d::Costmap2DROS*
 {
     thetaStarPlanner->initialize(name, costmap_ros);
 
-    map = new ROSMap(costmap_ros);
     distance = new L2ThetaDistance();
 
     //Get parameters from ros parameter server
@@ -88,6 +86,9 @@ void ThetaStarRRTPlanner::initialize(std::string name, costmap_2d::Costmap2DROS*
     private_nh.param("deltaTheta", deltaTheta, M_PI/4);
     private_nh.param("knn", knn, 10);
 
+    mapFactory.initialize(private_nh, costmap_ros);
+    map = &mapFactory.getMap();
+
     extenderFactory.initialize(private_nh, *map, *distance);
     visualizer.initialize(private_nh);
 
@@ -100,6 +101,8 @@ bool ThetaStarRRTPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                                    const geometry_msgs::PoseStamped& goal,
                                    std::vector<geometry_msgs::PoseStamped>& plan)
 {
+    StatsScope statsScope(stats);
+
 #ifdef VIS_CONF
     visualizer.clean();
 #endif
@@ -128,6 +131,7 @@ bool ThetaStarRRTPlanner::makePlan(const geometry_msgs::PoseStamped& start,
 #endif
 
     // Compute RRT-Theta* plan
+    map->update();
     Distance& distance = *this->distance;
 
     VectorXd&& x0 = convertPose(start);
@@ -292,9 +296,6 @@ ThetaStarRRTPlanner::~ThetaStarRRTPlanner()
     if(distance)
         delete distance;
 
-    if(map)
-        delete map;
-
     if(thetaStarPlanner)
         delete thetaStarPlanner;
 
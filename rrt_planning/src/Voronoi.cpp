@@ -24,10 +24,12 @@ Voronoi::Voronoi()
 {
     grid = nullptr;
     map = nullptr;
+    gridMap = nullptr;
 }
 
 Voronoi::Voronoi(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
 {
+    gridMap = nullptr;
     initialize(name, costmap_ros);
 }
 
@@ -40,7 +42,8 @@ void Voronoi::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros
     private_nh.param("discretization", discretization, 0.2);
     pub = private_nh.advertise<visualization_msgs::Marker>("/visualization_marker", 1);
 
-    map = new ROSMap(costmap_ros);
+    mapFactory.initialize(private_nh, costmap_ros);
+    map = &mapFactory.getMap();
     grid = new Grid(*map, discretization);
 
 	Bounds bounds = map->getBounds();
@@ -58,6 +61,8 @@ bool Voronoi::makePlan(const geometry_msgs::PoseStamped& start,
 #ifdef VIS_CONF
     visualizer.clean();
 #endif
+    map->update();
+
     //Init the position of the special states
     s_start = grid->convertPose(start);
     s_goal = grid->convertPose(goal);
@@ -328,24 +333,65 @@ bool Voronoi::findPath(std::vector<Cell>& path, int init_x, int init_y, int goal
 
 bool Voronoi::initVoronoi()
 {
-	bool **map=NULL;
-	map = new bool*[sizeX];
+	//Only recheck the cells changed since the last skeleton
+	Bounds changed;
+	if(!occupied.empty() && map->getChangedBounds(changed))
+	{
+		Bounds bounds = map->getBounds();
+		int minX = std::max(0, (int)floor((changed.minX - bounds.minX) / discretization - 0.5));
+		int minY = std::max(0, (int)floor((changed.minY - bounds.minY) / discretization - 0.5));
+		int maxX = std::min(sizeX, (int)ceil((changed.maxX - bounds.minX) / discretization + 0.5));
+		int maxY = std::min(sizeY, (int)ceil((changed.maxY - bounds.minY) / discretization + 0.5));
+
+		for(int y = minY; y < maxY; y++)
+		{
+			for(int x = minX; x < maxX; x++)
+			{
+				Cell c = make_pair(x, y);
+				bool obstacle = !grid->isVoronoiFree(c);
+
+				if(obstacle != occupied[x*sizeY + y])
+				{
+					if(obstacle)
+						voronoi_.occupyCell(x, y);
+					else
+						voronoi_.clearCell(x, y);
+
+					occupied[x*sizeY + y] = obstacle;
+				}
+			}
+		}
+
+		voronoi_.update();
+		voronoi_.prune();
 
-	for(int x = 0; x < sizeX; x++)
+		return true;
+	}
+
+	//The grid is handed to voronoi_, which frees it on destruction: allocate it once and refill it
+	if(!gridMap)
 	{
-		(map)[x] = new bool[sizeY];
+		gridMap = new bool*[sizeX];
+
+		for(int x = 0; x < sizeX; x++)
+		{
+			gridMap[x] = new bool[sizeY];
+		}
 	}
 
+	occupied.assign(sizeX*sizeY, false);
+
 	for(int y = sizeY-1; y >= 0; y--)
 	{
 		for(int x = 0; x < sizeX; x++)
 		{
 			Cell c = make_pair(x, y);
-			(map)[x][y] = !grid->isVoronoiFree(c);
+			gridMap[x][y] = !grid->isVoronoiFree(c);
+			occupied[x*sizeY + y] = gridMap[x][y];
 		}
 	}
 
-	voronoi_.initializeMap(sizeX, sizeY, map);
+	voronoi_.initializeMap(sizeX, sizeY, gridMap);
 	voronoi_.update();
 	voronoi_.prune();
 
@@ -464,9 +510,6 @@ Voronoi::~Voronoi()
 {
     if(grid)
         delete grid;
-
-    if(map)
-        delete map;
 }
 
 
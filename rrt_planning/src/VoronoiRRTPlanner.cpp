@@ -4,7 +4,6 @@
 #include "rrt_planning/VoronoiRRTPlanner.h"
 
 #include "rrt_planning/extenders/MotionPrimitivesExtender.h"
-#include "rrt_planning/map/ROSMap.h"
 #include "rrt_planning/kinematics_models/DifferentialDrive.h"
 #include "rrt_planning/utils/RandomGenerator.h"
 #include "rrt_planning/rrt/RRT.h"
@@ -57,7 +56,6 @@ void VoronoiRRTPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* c
     voronoiPlanner->initialize(name, costmap_ros);
     voronoi->initialize(name, costmap_ros);
 
-    map = new ROSMap(costmap_ros);
     distance = new L2ThetaDistance();
 
     //Parameters from ros parameters server
@@ -71,6 +69,9 @@ void VoronoiRRTPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* c
     private_nh.param("knn", knn, 10);
     private_nh.param("bias", bias, 1);
 
+    mapFactory.initialize(private_nh, costmap_ros);
+    map = &mapFactory.getMap();
+
     extenderFactory.initialize(private_nh, *map, *distance);
     visualizer.initialize(private_nh);
 
@@ -83,6 +84,8 @@ bool VoronoiRRTPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                             const geometry_msgs::PoseStamped& goal,
                             std::vector<geometry_msgs::PoseStamped>& plan)
 {
+    StatsScope statsScope(stats);
+
 #ifdef VIS_CONF
     visualizer.clean();
 #endif
@@ -109,6 +112,7 @@ bool VoronoiRRTPlanner::makePlan(const geometry_msgs::PoseStamped& start,
     ROS_FATAL_STREAM("voronoi length: " << voronoiPlan.size());
 #endif
     //Compute VoronoiRRT plan
+    map->update();
     Distance& distance = *this->distance;
 
     VectorXd&& x0 = convertPose(start);
@@ -274,10 +278,6 @@ VoronoiRRTPlanner::~VoronoiRRTPlanner()
         delete distance;
     }
 
-    if(map){
-        delete map;
-    }
-
     if(voronoiPlanner){
         delete voronoiPlanner;
     }
@@ -22,6 +22,7 @@
  */
 
 #include "rrt_planning/extenders/ClosedLoopExtender.h"
+#include "rrt_planning/utils/Stats.h"
 
 using namespace Eigen;
 using namespace std;
@@ -41,6 +42,9 @@ ClosedLoopExtender::ClosedLoopExtender(KinematicModel& model, Controller& contro
 
 bool ClosedLoopExtender::compute(const VectorXd& x0, const VectorXd& xRand, VectorXd& xNew)
 {
+    Stats::count(Stats::EXTENDER_COMPUTE);
+    StatsTimer timer(Stats::EXTENDER_TIME);
+
     controller.setGoal(xRand);
 
     VectorXd xStart = x0;
@@ -108,6 +112,8 @@ bool ClosedLoopExtender::check(const VectorXd& x0, const VectorXd& xGoal, std::v
 
 bool ClosedLoopExtender::los(const VectorXd& x0, const VectorXd& xRand, VectorXd& xNew)
 {
+    Stats::count(Stats::EXTENDER_LOS);
+
     controller.setGoal(xRand);
 
     bool valid = false;
@@ -124,6 +130,9 @@ bool ClosedLoopExtender::los(const VectorXd& x0, const VectorXd& xRand, VectorXd
 
 bool ClosedLoopExtender::steer(const VectorXd& xStart, const VectorXd& xCorner, VectorXd& xNew, vector<VectorXd>& parents, double& cost)
 {
+    Stats::count(Stats::EXTENDER_STEER);
+    StatsTimer timer(Stats::EXTENDER_TIME);
+
     controller.setGoal(xCorner);
     VectorXd xCurr = xStart;
     int j = 0;
@@ -143,6 +152,9 @@ bool ClosedLoopExtender::steer(const VectorXd& xStart, const VectorXd& xCorner,
 
 bool ClosedLoopExtender::steer_l2(const VectorXd& xStart, const VectorXd& xCorner, VectorXd& xNew, vector<VectorXd>& parents, double& cost)
 {
+    Stats::count(Stats::EXTENDER_STEER);
+    StatsTimer timer(Stats::EXTENDER_TIME);
+
     Distance& l2dis = *this->l2distance;
     controller.setGoal(xCorner);
     VectorXd xCurr = xStart;
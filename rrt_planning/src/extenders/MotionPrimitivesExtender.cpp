@@ -22,6 +22,10 @@
  */
 
 #include "rrt_planning/extenders/MotionPrimitivesExtender.h"
+#include "rrt_planning/utils/Stats.h"
+
+#include <algorithm>
+#include <set>
 
 using namespace Eigen;
 using namespace std;
@@ -35,12 +39,20 @@ MotionPrimitivesExtender::MotionPrimitivesExtender(KinematicModel& model, Consta
 {
     deltaT = 0;
     discretization = 0;
+    swept = false;
+    headingBuckets = 0;
+    sweptStep = 0;
+    sweptResolution = 0;
+    snapshot = dynamic_cast<SnapshotMap*>(&map);
     l2distance = new L2Distance();
     thetadistance = new ThetaDistance();
 }
 
 bool MotionPrimitivesExtender::compute(const VectorXd& x0, const VectorXd& xSample, VectorXd& xNew)
 {
+    Stats::count(Stats::EXTENDER_COMPUTE);
+    StatsTimer timer(Stats::EXTENDER_TIME);
+
     VectorXd xRand = xSample;
     if(diffDrive)
     {
@@ -52,19 +64,33 @@ bool MotionPrimitivesExtender::compute(const VectorXd& x0, const VectorXd& xSamp
         }
     }
 
-    double minDistance = std::numeric_limits<double>::infinity();
+    for(unsigned int i = 0; i < motionPrimitives.size(); i++)
+    {
+        candidates[i] = model.applyTransform(x0, motionPrimitives[i]);
+        candidatesXY.col(i) = candidates[i].head<2>();
+    }
 
-    for(auto& mp : motionPrimitives)
+    if(swept)
+    {
+        for(unsigned int i = 0; i < candidates.size(); i++)
+            candidatesFree(i) = isSweptFree(x0, i);
+    }
+    else
     {
-        VectorXd x = model.applyTransform(x0, mp);
+        map.isFreeBatch(candidatesXY, candidatesFree.data());
+    }
+
+    double minDistance = std::numeric_limits<double>::infinity();
 
-        if(map.isFree(x))
+    for(unsigned int i = 0; i < candidates.size(); i++)
+    {
+        if(candidatesFree(i))
         {
-            double currentDist = distance(xRand, x);
+            double currentDist = distance(xRand, candidates[i]);
 
             if(currentDist < minDistance)
             {
-                xNew = x;
+                xNew = candidates[i];
                 minDistance = currentDist;
             }
         }
@@ -75,6 +101,8 @@ bool MotionPrimitivesExtender::compute(const VectorXd& x0, const VectorXd& xSamp
 
 bool MotionPrimitivesExtender::los(const VectorXd& x0, const VectorXd& xSample, VectorXd& xNew)
 {
+    Stats::count(Stats::EXTENDER_LOS);
+
     VectorXd xRand = xSample;
     if(diffDrive)
     {
@@ -87,25 +115,33 @@ bool MotionPrimitivesExtender::los(const VectorXd& x0, const VectorXd& xSample,
     }
 
     double minDistance = std::numeric_limits<double>::infinity();
+    unsigned int best = 0;
 
-    for(auto& mp : motionPrimitives)
+    for(unsigned int i = 0; i < motionPrimitives.size(); i++)
     {
-        VectorXd x = model.applyTransform(x0, mp);
+        VectorXd x = model.applyTransform(x0, motionPrimitives[i]);
 
         double currentDist = distance(x, xRand);
         if(currentDist < minDistance)
         {
           xNew = x;
           minDistance = currentDist;
+          best = i;
         }
 
     }
 
-    return ((minDistance < std::numeric_limits<double>::infinity()) && map.isFree(xNew));
+    if(minDistance == std::numeric_limits<double>::infinity())
+        return false;
+
+    return swept ? isSweptFree(x0, best) : map.isFree(xNew);
 }
 
 bool MotionPrimitivesExtender::steer(const VectorXd& xStart, const VectorXd& xCorner, VectorXd& xNew, vector<VectorXd>& parents, double& cost)
 {
+    Stats::count(Stats::EXTENDER_STEER);
+    StatsTimer timer(Stats::EXTENDER_TIME);
+
 
     int j = 0;
 
@@ -132,6 +168,9 @@ bool MotionPrimitivesExtender::steer(const VectorXd& xStart, const VectorXd& xCo
 
 bool MotionPrimitivesExtender::steer_l2(const VectorXd& xStart, const VectorXd& xCorner, VectorXd& xNew, vector<VectorXd>& parents, double& cost)
 {
+    Stats::count(Stats::EXTENDER_STEER);
+    StatsTimer timer(Stats::EXTENDER_TIME);
+
     //Separates the length check from the angle check
     Distance& l2dis = *this->l2distance;
 
@@ -213,6 +252,13 @@ void MotionPrimitivesExtender::initialize(ros::NodeHandle& nh)
     nh.param("motion_primitives/discretization", discretization, 5);
     nh.param("K", K, -1);
 
+    nh.param("motion_primitives/swept", swept, false);
+    nh.param("motion_primitives/heading_buckets", headingBuckets, 72);
+    nh.param("motion_primitives/swept_step", sweptStep, 0.025);
+
+    //The swept check reads the cells of the snapshot directly
+    swept = swept && snapshot;
+
     std::vector<double> minU_vec;
     std::vector<double> maxU_vec;
 
@@ -258,6 +304,13 @@ void MotionPrimitivesExtender::generateMotionPrimitives()
     VectorXd dU = (maxU - minU) / (discretization-1.0);
 
     generateMotionPrimitive(minU, dU, 0);
+
+    candidates.resize(motionPrimitives.size());
+    candidatesXY.resize(2, motionPrimitives.size());
+    candidatesFree.resize(motionPrimitives.size());
+
+    if(swept)
+        generateSweptCells();
 }
 
 void MotionPrimitivesExtender::generateMotionPrimitive(const Eigen::VectorXd& u, const Eigen::VectorXd& du, unsigned int index)
@@ -267,6 +320,24 @@ void MotionPrimitivesExtender::generateMotionPrimitive(const Eigen::VectorXd& u,
         controller.setControl(u);
         VectorXd&& mp = model.compute(model.getInitialState(), deltaT);
         motionPrimitives.push_back(mp);
+
+        if(swept)
+        {
+            //Sample the trajectory densely enough to cover arcs up to half a turn
+            double chord = mp.head<2>().norm();
+            int n = std::ceil(M_PI / 2 * chord / sweptStep) + 1;
+
+            Matrix2Xd trajectory(2, n + 1);
+            trajectory.col(0).setZero();
+
+            for(int i = 1; i <= n; i++)
+            {
+                VectorXd&& x = model.compute(model.getInitialState(), deltaT * i / n);
+                trajectory.col(i) = x.head<2>();
+            }
+
+            trajectories.push_back(trajectory);
+        }
     }
     else
     {
@@ -279,6 +350,109 @@ void MotionPrimitivesExtender::generateMotionPrimitive(const Eigen::VectorXd& u,
     }
 }
 
+void MotionPrimitivesExtender::generateSweptCells()
+{
+    sweptResolution = snapshot->getResolution();
+    sweptCells.assign(motionPrimitives.size() * headingBuckets, SweptCells());
+
+    double bucketSize = 2*M_PI / headingBuckets;
+
+    for(unsigned int i = 0; i < trajectories.size(); i++)
+    {
+        const Matrix2Xd& trajectory = trajectories[i];
+
+        //Arcs up to half a turn between two samples stay within a quarter turn of their chord
+        double gap = 0;
+        for(int k = 1; k < trajectory.cols(); k++)
+            gap = std::max(gap, (trajectory.col(k) - trajectory.col(k - 1)).norm());
+
+        double between = gap * M_PI / 4;
+
+        for(int b = 0; b < headingBuckets; b++)
+        {
+            SweptCells& cells = sweptCells[i*headingBuckets + b];
+            set<pair<int, int>> visited;
+
+            cells.minX = cells.minY = 0;
+            cells.maxX = cells.maxY = 0;
+
+            double theta = b*bucketSize;
+            Matrix2d R;
+            R << cos(theta), -sin(theta),
+                 sin(theta),  cos(theta);
+
+            Matrix2Xd rotated = R * trajectory / sweptResolution;
+
+            for(int k = 0; k < rotated.cols(); k++)
+            {
+                //Any heading of the bucket moves the points between this sample and the
+                //next ones by at most their distance from the start times half the bucket
+                double length = trajectory.col(k).norm() + between;
+                double radius = (length * bucketSize / 2 + between) / sweptResolution;
+
+                //The start point may lie anywhere inside its cell, so the sample covers
+                //the unit square from its offset, grown by the radius
+                double px = rotated(0, k);
+                double py = rotated(1, k);
+
+                for(int x = std::floor(px - radius); x <= std::floor(px + 1 + radius); x++)
+                {
+                    for(int y = std::floor(py - radius); y <= std::floor(py + 1 + radius); y++)
+                    {
+                        double dx = std::max({0.0, x - (px + 1), px - (x + 1)});
+                        double dy = std::max({0.0, y - (py + 1), py - (y + 1)});
+
+                        if(dx*dx + dy*dy > radius*radius)
+                            continue;
+
+                        pair<int, int> offset(x, y);
+
+                        if(visited.insert(offset).second)
+                        {
+                            cells.offsets.push_back(offset);
+                            cells.minX = std::min(cells.minX, offset.first);
+                            cells.maxX = std::max(cells.maxX, offset.first);
+                            cells.minY = std::min(cells.minY, offset.second);
+                            cells.maxY = std::max(cells.maxY, offset.second);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool MotionPrimitivesExtender::isSweptFree(const VectorXd& x0, unsigned int primitive)
+{
+    if(snapshot->getResolution() != sweptResolution)
+        generateSweptCells();
+
+    int mx, my;
+    if(!snapshot->worldToMap(x0(0), x0(1), mx, my))
+        return false;
+
+    double theta = x0(2) - 2*M_PI*std::floor(x0(2) / (2*M_PI));
+    int bucket = static_cast<int>(std::lround(theta * headingBuckets / (2*M_PI))) % headingBuckets;
+    const SweptCells& cells = sweptCells[primitive*headingBuckets + bucket];
+
+    bool inside = mx + cells.minX >= 0 && mx + cells.maxX < snapshot->getSizeX() &&
+                  my + cells.minY >= 0 && my + cells.maxY < snapshot->getSizeY();
+
+    for(auto& offset : cells.offsets)
+    {
+        int x = mx + offset.first;
+        int y = my + offset.second;
+
+        if(!inside && (x < 0 || y < 0 || x >= snapshot->getSizeX() || y >= snapshot->getSizeY()))
+            return false;
+
+        if(!snapshot->isFreeCell(x, y))
+            return false;
+    }
+
+    return true;
+}
+
 MotionPrimitivesExtender::~MotionPrimitivesExtender()
 {
 
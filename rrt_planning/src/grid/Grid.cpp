@@ -126,6 +126,13 @@ bool Grid::lineOfSight(const Cell& s, const Cell& s_next)
     int X2 = s_next.first;
     int Y2 = s_next.second;
 
+    //The cells visited below are within half a cell of the segment, so only
+    //the ones past the free part of the corridor need to be checked
+    double freeFraction = map.getFreeFraction(toMapPose(X1, Y1), toMapPose(X2, Y2), 0.5 * gridResolution);
+
+    if(freeFraction > 1)
+        return true;
+
     //Determine how steep the line is
     bool is_steep = abs(Y2-Y1) > abs(X2-X1);
 
@@ -143,6 +150,7 @@ bool Grid::lineOfSight(const Cell& s, const Cell& s_next)
     {
         swap(X1, X2);
         swap(Y1, Y2);
+        swapped = true;
     }
 
     int error = (X2 - X1) / 2;
@@ -153,14 +161,19 @@ bool Grid::lineOfSight(const Cell& s, const Cell& s_next)
     //Check for obstalces through the line
     for(int x = X1; x <= X2; x++)
     {
-        Eigen::VectorXd pos;
+        int steps = swapped ? X2 - x : x - X1;
 
-        if(is_steep)
-            pos = toMapPose(y, x);
-        else
-            pos = toMapPose(x, y);
+        if(steps >= freeFraction * (X2 - X1))
+        {
+            Eigen::VectorXd pos;
 
-        if(!map.isFree(pos)) return false;
+            if(is_steep)
+                pos = toMapPose(y, x);
+            else
+                pos = toMapPose(x, y);
+
+            if(!map.isFree(pos)) return false;
+        }
 
         error -= abs(Y2 - Y1);
         if(error < 0)
@@ -0,0 +1,194 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/ClearanceField.h"
+#include "rrt_planning/map/MapVersion.h"
+
+namespace rrt_planning
+{
+
+ClearanceField::ClearanceField()
+{
+    voronoi = nullptr;
+    sizeX = 0;
+    sizeY = 0;
+    resolution = 0;
+}
+
+void ClearanceField::update(const MapVersion& map)
+{
+    resolution = map.getResolution();
+
+    if(!voronoi || map.getSizeX() != sizeX || map.getSizeY() != sizeY)
+        initialize(map);
+    else
+        applyChanges(map, 0, 0, sizeX, sizeY);
+
+    voronoi->update();
+}
+
+void ClearanceField::update(const MapVersion& map, int minX, int minY, int maxX, int maxY)
+{
+    if(!voronoi || map.getSizeX() != sizeX || map.getSizeY() != sizeY ||
+            map.getResolution() != resolution)
+    {
+        update(map);
+        return;
+    }
+
+    applyChanges(map, minX, minY, maxX, maxY);
+    voronoi->update();
+}
+
+void ClearanceField::initialize(const MapVersion& map)
+{
+    sizeX = map.getSizeX();
+    sizeY = map.getSizeY();
+
+    occupied.assign(static_cast<std::size_t>(sizeX) * sizeY, false);
+
+    //DynamicVoronoi takes ownership of the grid
+    int paddedX = sizeX + 2;
+    int paddedY = sizeY + 2;
+    bool** grid = new bool*[paddedX];
+
+    for(int x = 0; x < paddedX; x++)
+    {
+        grid[x] = new bool[paddedY];
+
+        for(int y = 0; y < paddedY; y++)
+        {
+            if(x == 0 || y == 0 || x == paddedX - 1 || y == paddedY - 1)
+            {
+                grid[x][y] = true;
+            }
+            else
+            {
+                bool obstacle = !map.isFreeCell(x - 1, y - 1);
+                occupied[static_cast<std::size_t>(y - 1) * sizeX + x - 1] = obstacle;
+                grid[x][y] = obstacle;
+            }
+        }
+    }
+
+    //DynamicVoronoi cannot be reinitialized with a different size
+    delete voronoi;
+    voronoi = new DynamicVoronoi();
+    voronoi->initializeMap(paddedX, paddedY, grid);
+}
+
+void ClearanceField::applyChanges(const MapVersion& map, int minX, int minY, int maxX, int maxY)
+{
+    for(int y = minY; y < maxY; y++)
+    {
+        for(int x = minX; x < maxX; x++)
+        {
+            std::size_t index = static_cast<std::size_t>(y) * sizeX + x;
+            bool obstacle = !map.isFreeCell(x, y);
+
+            if(obstacle != occupied[index])
+            {
+                if(obstacle)
+                    voronoi->occupyCell(x + 1, y + 1);
+                else
+                    voronoi->clearCell(x + 1, y + 1);
+
+                occupied[index] = obstacle;
+            }
+        }
+    }
+}
+
+void ClearanceField::fill(TiledLayer<float>& clearance) const
+{
+    clearance.assign(sizeX, sizeY, 0);
+
+    for(int y = 0; y < sizeY; y++)
+        for(int x = 0; x < sizeX; x++)
+            fillCell(clearance, x, y);
+}
+
+void ClearanceField::fill(TiledLayer<float>& clearance, int minX, int minY, int maxX, int maxY) const
+{
+    if(clearance.getSizeX() != sizeX || clearance.getSizeY() != sizeY)
+    {
+        fill(clearance);
+        return;
+    }
+
+    //A cell changes only if the window is closer than its old or new distance.
+    //Distances change by at most one per cell, so once every cell of a ring
+    //around the window is farther from it than both distances, with a margin
+    //for the discretization, no cell outside the ring can have changed
+    for(int ring = 0;; ring++)
+    {
+        int x0 = minX - ring;
+        int y0 = minY - ring;
+        int x1 = maxX + ring;
+        int y1 = maxY + ring;
+
+        if(x0 < 0 && y0 < 0 && x1 > sizeX && y1 > sizeY)
+            break;
+
+        double reach = 0;
+
+        for(int y = std::max(y0, 0); y < std::min(y1, sizeY); y++)
+        {
+            //Inner rows hold only the two side cells of the ring
+            bool border = ring == 0 || y == y0 || y == y1 - 1;
+            int step = border ? 1 : x1 - 1 - x0;
+
+            for(int x = x0; x < x1; x += step)
+                if(x >= 0 && x < sizeX)
+                    reach = std::max(reach, fillCell(clearance, x, y));
+        }
+
+        if(ring > 0 && reach < ring - 3)
+            break;
+    }
+}
+
+double ClearanceField::fillCell(TiledLayer<float>& clearance, int mx, int my) const
+{
+    //Rounded down, the clearance must never be overestimated
+    double value = getClearanceCell(mx, my);
+    float stored = value;
+    if(stored > value)
+        stored = std::nextafter(stored, 0.0f);
+
+    //Distances in cells, the old one bounded from the stored clearance
+    double distance = voronoi->getDistance(mx + 1, my + 1);
+    double old = clearance(mx, my) / resolution + M_SQRT2;
+
+    if(clearance(mx, my) != stored)
+        clearance.at(mx, my) = stored;
+
+    return std::max(distance, old);
+}
+
+ClearanceField::~ClearanceField()
+{
+    delete voronoi;
+}
+
+}
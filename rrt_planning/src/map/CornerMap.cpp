@@ -0,0 +1,233 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/CornerMap.h"
+#include "rrt_planning/map/MapVersion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rrt_planning
+{
+
+//Mask of the bits of word that lie in [begin, end)
+static inline uint64_t rangeMask(std::size_t word, std::size_t begin, std::size_t end)
+{
+    uint64_t mask = ~uint64_t(0);
+
+    if(word == begin >> 6)
+        mask &= ~uint64_t(0) << (begin & 63);
+
+    if(word == (end - 1) >> 6)
+        mask &= ~uint64_t(0) >> (63 - ((end - 1) & 63));
+
+    return mask;
+}
+
+CornerMap::CornerMap()
+{
+    sizeX = 0;
+    sizeY = 0;
+    radius = 0;
+    threshold = 0;
+}
+
+void CornerMap::update(const MapVersion& map, double radius, double threshold)
+{
+    this->radius = radius;
+    this->threshold = threshold;
+
+    //Two samples for each cell along the ring
+    int samples = std::max(16, static_cast<int>(std::ceil(4 * M_PI * radius)));
+    ringX.resize(samples);
+    ringY.resize(samples);
+
+    for(int i = 0; i < samples; i++)
+    {
+        ringX[i] = radius * std::cos(2 * M_PI * i / samples);
+        ringY[i] = radius * std::sin(2 * M_PI * i / samples);
+    }
+
+    sizeX = map.getSizeX();
+    sizeY = map.getSizeY();
+
+    bits.assign((sizeX + 63) / 64, sizeY, 0);
+    directions.assign(sizeX, sizeY, 0);
+
+    classify(map, 0, 0, sizeX, sizeY);
+}
+
+void CornerMap::update(const MapVersion& map, int minX, int minY, int maxX, int maxY)
+{
+    if(isEmpty())
+        return;
+
+    //Rings of the cells around the window may reach the changed cells
+    int margin = static_cast<int>(std::ceil(radius)) + 1;
+
+    classify(map, std::max(minX - margin, 0), std::max(minY - margin, 0),
+             std::min(maxX + margin, sizeX), std::min(maxY + margin, sizeY));
+}
+
+bool CornerMap::isCorner(const MapVersion& map, double x, double y, double radius) const
+{
+    int px = static_cast<int>(std::floor(x));
+    int py = static_cast<int>(std::floor(y));
+
+    if(px < 0 || py < 0 || px >= sizeX || py >= sizeY || !map.isFreeCell(px, py))
+        return false;
+
+    int minY = static_cast<int>(std::floor(y - radius));
+    int maxY = static_cast<int>(std::floor(y + radius));
+
+    //Leaving the map counts as meeting an obstacle
+    bool free = minY >= 0 && maxY < sizeY;
+
+    for(int my = std::max(minY, 0); my <= std::min(maxY, sizeY - 1); my++)
+    {
+        //Cells of the row that intersect the disc
+        double dy = (y < my) ? my - y : ((y > my + 1) ? y - (my + 1) : 0);
+        double half = std::sqrt(std::max(radius * radius - dy * dy, 0.0));
+        int minX = static_cast<int>(std::floor(x - half));
+        int maxX = static_cast<int>(std::floor(x + half));
+
+        if(minX < 0 || maxX >= sizeX)
+            free = false;
+
+        std::size_t begin = std::max(minX, 0);
+        std::size_t end = std::min(maxX, sizeX - 1) + 1;
+
+        for(std::size_t word = begin >> 6; word <= (end - 1) >> 6; word++)
+        {
+            uint64_t mask = rangeMask(word, begin, end);
+
+            if(free && (map.freeBits(word, my) & mask) != mask)
+                free = false;
+
+            for(uint64_t corners = bits(word, my) & mask; corners; corners &= corners - 1)
+            {
+                int mx = (word << 6) + __builtin_ctzll(corners);
+                double vx = x - (mx + 0.5);
+                double vy = y - (my + 0.5);
+                double distance = std::sqrt(vx * vx + vy * vy);
+
+                if(distance > radius)
+                    continue;
+
+                //The point must lie in the cone of 45 degrees around the corner direction
+                unsigned char direction = directions(mx, my);
+                if(direction == OMNI)
+                    return true;
+
+                double angle = direction * 2 * M_PI / OMNI;
+                if(vx * std::cos(angle) + vy * std::sin(angle) >= M_SQRT1_2 * distance)
+                    return true;
+            }
+        }
+    }
+
+    return free;
+}
+
+void CornerMap::classify(const MapVersion& map, int minX, int minY, int maxX, int maxY)
+{
+    for(int my = minY; my < maxY; my++)
+    {
+        for(int mx = minX; mx < maxX; mx++)
+        {
+            unsigned char direction = 0;
+            bool corner = isBoundary(map, mx, my) && isConvex(map, mx, my, direction);
+
+            //Cells are written only when they change, so that unchanged tiles stay shared
+            uint64_t word = bits(mx >> 6, my);
+            uint64_t bit = uint64_t(1) << (mx & 63);
+            uint64_t next = corner ? (word | bit) : (word & ~bit);
+
+            if(next != word)
+                bits.at(mx >> 6, my) = next;
+
+            if(corner && directions(mx, my) != direction)
+                directions.at(mx, my) = direction;
+        }
+    }
+}
+
+bool CornerMap::isConvex(const MapVersion& map, int mx, int my, unsigned char& direction) const
+{
+    int samples = ringX.size();
+    int blocked = 0;
+    double freeX = 0;
+    double freeY = 0;
+
+    for(int i = 0; i < samples; i++)
+    {
+        if(isBlocked(map, mx + 0.5 + ringX[i], my + 0.5 + ringY[i]))
+        {
+            blocked++;
+        }
+        else
+        {
+            freeX += ringX[i];
+            freeY += ringY[i];
+        }
+    }
+
+    if(blocked >= threshold * samples || blocked == samples)
+        return false;
+
+    //A free ring without a dominant direction is seen from everywhere
+    double length = std::sqrt(freeX * freeX + freeY * freeY) / (samples - blocked);
+    if(length < radius / 4)
+    {
+        direction = OMNI;
+    }
+    else
+    {
+        double angle = std::atan2(freeY, freeX);
+        if(angle < 0)
+            angle += 2 * M_PI;
+
+        direction = static_cast<int>(std::round(angle / (2 * M_PI) * OMNI)) % OMNI;
+    }
+
+    return true;
+}
+
+bool CornerMap::isBoundary(const MapVersion& map, int mx, int my) const
+{
+    if(map.isFreeCell(mx, my))
+        return false;
+
+    return (mx > 0 && map.isFreeCell(mx - 1, my)) || (mx + 1 < sizeX && map.isFreeCell(mx + 1, my)) ||
+           (my > 0 && map.isFreeCell(mx, my - 1)) || (my + 1 < sizeY && map.isFreeCell(mx, my + 1));
+}
+
+bool CornerMap::isBlocked(const MapVersion& map, double x, double y) const
+{
+    if(x < 0 || y < 0 || x >= sizeX || y >= sizeY)
+        return true;
+
+    return !map.isFreeCell(static_cast<int>(x), static_cast<int>(y));
+}
+
+}
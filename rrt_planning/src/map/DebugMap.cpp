@@ -22,6 +22,7 @@
  */
 
 #include "rrt_planning/map/DebugMap.h"
+#include "rrt_planning/utils/Stats.h"
 
 namespace rrt_planning
 {
@@ -33,6 +34,7 @@ DebugMap::DebugMap()
 
 bool DebugMap::isFree(const Eigen::VectorXd& p)
 {
+    Stats::count(Stats::MAP_IS_FREE);
     return true;
 }
 
@@ -0,0 +1,135 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/MapFactory.h"
+
+#include "rrt_planning/map/MappedMap.h"
+#include "rrt_planning/map/ROSMap.h"
+#include "rrt_planning/map/SnapshotMap.h"
+
+#include <stdexcept>
+
+//#define DEBUG_CONF
+
+namespace rrt_planning
+{
+
+MapFactory::MapFactory()
+{
+    map = nullptr;
+    owned = false;
+}
+
+void MapFactory::initialize(ros::NodeHandle& nh, costmap_2d::Costmap2DROS* costmap_ros)
+{
+    std::string mapName;
+    nh.param("map", mapName, std::string("ROSMap"));
+    owned = true;
+
+    if(mapName == "ROSMap")
+    {
+        map = new ROSMap(costmap_ros);
+#ifdef DEBUG_CONF
+        ROS_FATAL("ROS map");
+#endif
+    }
+    else if(mapName == "Snapshot")
+    {
+        SnapshotMap* snapshot = new SnapshotMap(costmap_ros);
+
+        bool clearance;
+        nh.param("clearance", clearance, false);
+        if(clearance)
+            snapshot->enableClearance();
+
+        enableCorners(nh, snapshot);
+
+        bool incremental;
+        nh.param("incremental", incremental, false);
+        if(incremental)
+            snapshot->enableIncremental(nh);
+
+        map = snapshot;
+#ifdef DEBUG_CONF
+        ROS_FATAL("Snapshot map");
+#endif
+    }
+    else if(mapName == "Mapped")
+    {
+        std::string mapFile;
+        nh.param("map_file", mapFile, std::string(""));
+
+        //Shared with every other planner using the same file
+        sharedMap = MappedMap::open(mapFile);
+        map = sharedMap.get();
+        owned = false;
+#ifdef DEBUG_CONF
+        ROS_FATAL("Mapped map");
+#endif
+    }
+    else
+    {
+        throw std::runtime_error("Unknown map " + mapName);
+    }
+}
+
+void MapFactory::initialize(ros::NodeHandle& nh, Map& map)
+{
+    this->map = &map;
+    owned = false;
+
+    //Layers are shared by all the planners of the map
+    SnapshotMap* snapshot = dynamic_cast<SnapshotMap*>(&map);
+
+    bool clearance;
+    nh.param("clearance", clearance, false);
+    if(snapshot && clearance)
+        snapshot->enableClearance();
+
+    if(snapshot)
+        enableCorners(nh, snapshot);
+}
+
+void MapFactory::enableCorners(ros::NodeHandle& nh, SnapshotMap* snapshot)
+{
+    bool corners;
+    nh.param("corners", corners, false);
+
+    if(!corners)
+        return;
+
+    //Same scale and threshold used by SGMap
+    double cornerStep, threshold;
+    nh.param("corner_step", cornerStep, 0.1);
+    nh.param("threshold", threshold, 0.4);
+
+    snapshot->enableCorners(cornerStep, threshold);
+}
+
+MapFactory::~MapFactory()
+{
+    if(map && owned)
+        delete map;
+}
+
+}
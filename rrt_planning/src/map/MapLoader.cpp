@@ -0,0 +1,428 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/MapLoader.h"
+
+#include <costmap_2d/cost_values.h>
+#include <png.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace rrt_planning
+{
+
+MapLoader::MapLoader()
+{
+    sizeX = 0;
+    sizeY = 0;
+    resolution = 0;
+    originX = 0;
+    originY = 0;
+
+    //costmap_2d defaults
+    trackUnknown = false;
+    lethalThreshold = 100;
+    inflationRadius = 0.55;
+    costScalingFactor = 10.0;
+    robotRadius = 0.46;
+    footprintPadding = 0.01;
+    inscribedRadius = 0;
+}
+
+void MapLoader::loadCostmapParams(const std::string& filename)
+{
+    YAML::Node params = YAML::LoadFile(filename);
+
+    readParams(params);
+
+    //Parameters loaded in the global costmap namespace
+    if(params["global_costmap"])
+        readParams(params["global_costmap"]);
+}
+
+void MapLoader::readParams(const YAML::Node& node)
+{
+    if(node["track_unknown_space"])
+        trackUnknown = node["track_unknown_space"].as<bool>();
+
+    if(node["lethal_cost_threshold"])
+        lethalThreshold = node["lethal_cost_threshold"].as<int>();
+
+    if(node["inflation_radius"])
+        inflationRadius = node["inflation_radius"].as<double>();
+
+    if(node["cost_scaling_factor"])
+        costScalingFactor = node["cost_scaling_factor"].as<double>();
+
+    if(node["robot_radius"])
+        robotRadius = node["robot_radius"].as<double>();
+
+    if(node["footprint_padding"])
+        footprintPadding = node["footprint_padding"].as<double>();
+
+    if(node["footprint"])
+    {
+        footprint.clear();
+
+        for(auto point : node["footprint"])
+            footprint.push_back(Eigen::Vector2d(point[0].as<double>(), point[1].as<double>()));
+    }
+}
+
+void MapLoader::loadMap(const std::string& filename)
+{
+    YAML::Node descriptor = YAML::LoadFile(filename);
+
+    std::string mode = descriptor["mode"] ? descriptor["mode"].as<std::string>() : "trinary";
+    if(mode != "trinary")
+        throw std::runtime_error("Unsupported map mode " + mode);
+
+    resolution = descriptor["resolution"].as<double>();
+    originX = descriptor["origin"][0].as<double>();
+    originY = descriptor["origin"][1].as<double>();
+
+    bool negate = descriptor["negate"].as<int>();
+    double occupiedThreshold = descriptor["occupied_thresh"].as<double>();
+    double freeThreshold = descriptor["free_thresh"].as<double>();
+
+    //The image path is relative to the descriptor
+    std::string image = descriptor["image"].as<std::string>();
+    if(image[0] != '/')
+    {
+        std::size_t slash = filename.find_last_of('/');
+        if(slash != std::string::npos)
+            image = filename.substr(0, slash + 1) + image;
+    }
+
+    std::vector<unsigned char> pixels;
+    int channels;
+    readImage(image, pixels, channels);
+
+    unsigned char unknown = trackUnknown ? costmap_2d::NO_INFORMATION : costmap_2d::FREE_SPACE;
+    costs.resize(static_cast<std::size_t>(sizeX) * sizeY);
+
+    //map_server averages all the channels, alpha included, in trinary mode.
+    //The first image row is the top of the map
+    for(int row = 0; row < sizeY; row++)
+    {
+        for(int x = 0; x < sizeX; x++)
+        {
+            const unsigned char* pixel = &pixels[(static_cast<std::size_t>(row) * sizeX + x) * channels];
+
+            double color = 0;
+            for(int k = 0; k < channels; k++)
+                color += pixel[k];
+            color /= channels;
+
+            if(negate)
+                color = 255 - color;
+
+            double occupancy = (255 - color) / 255.0;
+
+            unsigned char cost;
+            if(occupancy > occupiedThreshold)
+                cost = (100 >= lethalThreshold) ? costmap_2d::LETHAL_OBSTACLE : costmap_2d::FREE_SPACE;
+            else if(occupancy < freeThreshold)
+                cost = costmap_2d::FREE_SPACE;
+            else
+                cost = unknown;
+
+            costs[static_cast<std::size_t>(sizeY - row - 1) * sizeX + x] = cost;
+        }
+    }
+
+    inflate();
+}
+
+SnapshotMap* MapLoader::createMap()
+{
+    if(costs.empty())
+        throw std::runtime_error("No map loaded");
+
+    return new SnapshotMap(sizeX, sizeY, resolution, originX, originY, costs.data());
+}
+
+void MapLoader::readImage(const std::string& filename, std::vector<unsigned char>& pixels, int& channels)
+{
+    std::string extension = filename.substr(filename.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if(extension == "png")
+        readPNG(filename, pixels, channels);
+    else if(extension == "pgm")
+        readPGM(filename, pixels, channels);
+    else if(extension == "bmp")
+        readBMP(filename, pixels, channels);
+    else
+        throw std::runtime_error("Unknown image format " + extension);
+}
+
+void MapLoader::readPNG(const std::string& filename, std::vector<unsigned char>& pixels, int& channels)
+{
+    png_image image;
+    std::memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if(!png_image_begin_read_from_file(&image, filename.c_str()))
+        throw std::runtime_error("Cannot read " + filename + ": " + image.message);
+
+    //Keep the channels of the file, palettes are expanded
+    image.format &= PNG_FORMAT_FLAG_COLOR | PNG_FORMAT_FLAG_ALPHA;
+    channels = PNG_IMAGE_SAMPLE_CHANNELS(image.format);
+
+    sizeX = image.width;
+    sizeY = image.height;
+    pixels.resize(PNG_IMAGE_SIZE(image));
+
+    if(!png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr))
+        throw std::runtime_error("Cannot read " + filename + ": " + image.message);
+}
+
+void MapLoader::readPGM(const std::string& filename, std::vector<unsigned char>& pixels, int& channels)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if(!file)
+        throw std::runtime_error("Cannot open " + filename);
+
+    //Header tokens, skipping comments
+    auto token = [&file]()
+    {
+        std::string value;
+        while(file >> value && value[0] == '#')
+            std::getline(file, value);
+        return value;
+    };
+
+    std::string magic = token();
+    if(magic != "P5" && magic != "P2")
+        throw std::runtime_error("Unsupported PGM " + filename);
+
+    sizeX = std::stoi(token());
+    sizeY = std::stoi(token());
+    int maxValue = std::stoi(token());
+    channels = 1;
+
+    std::size_t size = static_cast<std::size_t>(sizeX) * sizeY;
+    pixels.resize(size);
+
+    if(magic == "P5")
+    {
+        if(maxValue > 255)
+            throw std::runtime_error("Unsupported 16 bit PGM " + filename);
+
+        file.get();
+        file.read(reinterpret_cast<char*>(pixels.data()), size);
+    }
+    else
+    {
+        for(std::size_t i = 0; i < size; i++)
+        {
+            int value;
+            file >> value;
+            pixels[i] = value;
+        }
+    }
+
+    if(!file)
+        throw std::runtime_error("Truncated PGM " + filename);
+
+    if(maxValue != 255)
+    {
+        for(auto& pixel : pixels)
+            pixel = pixel * 255 / maxValue;
+    }
+}
+
+void MapLoader::readBMP(const std::string& filename, std::vector<unsigned char>& pixels, int& channels)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if(!file)
+        throw std::runtime_error("Cannot open " + filename);
+
+    unsigned char header[54];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if(!file || header[0] != 'B' || header[1] != 'M')
+        throw std::runtime_error("Invalid BMP " + filename);
+
+    auto read32 = [&header](int offset)
+    {
+        return static_cast<int32_t>(header[offset] | (header[offset + 1] << 8) |
+                                    (header[offset + 2] << 16) | (header[offset + 3] << 24));
+    };
+
+    int dataOffset = read32(10);
+    int width = read32(18);
+    int height = read32(22);
+    int bits = header[28] | (header[29] << 8);
+    int compression = read32(30);
+
+    if(compression != 0 || (bits != 8 && bits != 24 && bits != 32))
+        throw std::runtime_error("Unsupported BMP " + filename);
+
+    //Rows are stored bottom up, unless the height is negative.
+    //As with map_server, 8 bit images use the palette index as gray value
+    bool bottomUp = height > 0;
+    sizeX = width;
+    sizeY = std::abs(height);
+    channels = bits / 8;
+
+    std::size_t rowSize = (static_cast<std::size_t>(width) * bits / 8 + 3) & ~std::size_t(3);
+    std::vector<unsigned char> row(rowSize);
+    pixels.resize(static_cast<std::size_t>(sizeX) * sizeY * channels);
+
+    file.seekg(dataOffset);
+
+    for(int r = 0; r < sizeY; r++)
+    {
+        file.read(reinterpret_cast<char*>(row.data()), rowSize);
+        if(!file)
+            throw std::runtime_error("Truncated BMP " + filename);
+
+        int y = bottomUp ? sizeY - r - 1 : r;
+        std::copy(row.begin(), row.begin() + sizeX * channels,
+                  pixels.begin() + static_cast<std::size_t>(y) * sizeX * channels);
+    }
+}
+
+void MapLoader::inflate()
+{
+    inscribedRadius = computeInscribedRadius();
+
+    int cellRadius = std::ceil(inflationRadius / resolution);
+    int width = 2*cellRadius + 1;
+
+    //Cost of every offset inside the inflation radius, as in the inflation layer cache
+    std::vector<unsigned char> kernel(width * width, 0);
+    for(int dy = -cellRadius; dy <= cellRadius; dy++)
+    {
+        for(int dx = -cellRadius; dx <= cellRadius; dx++)
+        {
+            double distance = std::hypot(dx, dy);
+            if(distance <= cellRadius)
+                kernel[(dy + cellRadius) * width + dx + cellRadius] = computeCost(distance);
+        }
+    }
+
+    auto isLethal = [this](int x, int y)
+    {
+        return costs[static_cast<std::size_t>(y) * sizeX + x] == costmap_2d::LETHAL_OBSTACLE;
+    };
+
+    std::vector<unsigned char> inflation(costs.size(), 0);
+
+    //The closest obstacle of a cell always has a non lethal 4-neighbour
+    for(int y = 0; y < sizeY; y++)
+    {
+        for(int x = 0; x < sizeX; x++)
+        {
+            if(!isLethal(x, y))
+                continue;
+
+            bool border = (x > 0 && !isLethal(x - 1, y)) || (x + 1 < sizeX && !isLethal(x + 1, y)) ||
+                          (y > 0 && !isLethal(x, y - 1)) || (y + 1 < sizeY && !isLethal(x, y + 1));
+
+            if(!border)
+                continue;
+
+            int minY = std::max(0, y - cellRadius);
+            int maxY = std::min(sizeY - 1, y + cellRadius);
+            int minX = std::max(0, x - cellRadius);
+            int maxX = std::min(sizeX - 1, x + cellRadius);
+
+            for(int ny = minY; ny <= maxY; ny++)
+            {
+                const unsigned char* k = &kernel[(ny - y + cellRadius) * width + cellRadius - x];
+                unsigned char* out = &inflation[static_cast<std::size_t>(ny) * sizeX];
+
+                for(int nx = minX; nx <= maxX; nx++)
+                    out[nx] = std::max(out[nx], k[nx]);
+            }
+        }
+    }
+
+    //Unknown cells are only overwritten by lethal and inscribed costs
+    for(std::size_t i = 0; i < costs.size(); i++)
+    {
+        if(costs[i] == costmap_2d::NO_INFORMATION)
+        {
+            if(inflation[i] >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+                costs[i] = inflation[i];
+        }
+        else
+        {
+            costs[i] = std::max(costs[i], inflation[i]);
+        }
+    }
+}
+
+double MapLoader::computeInscribedRadius()
+{
+    if(footprint.size() < 3)
+        return robotRadius + footprintPadding;
+
+    //Padded footprint, then distance from the center to the closest edge
+    std::vector<Eigen::Vector2d> padded = footprint;
+    for(auto& point : padded)
+    {
+        point(0) += (point(0) > 0 ? 1 : (point(0) < 0 ? -1 : 0)) * footprintPadding;
+        point(1) += (point(1) > 0 ? 1 : (point(1) < 0 ? -1 : 0)) * footprintPadding;
+    }
+
+    double radius = std::numeric_limits<double>::infinity();
+    for(unsigned int i = 0; i < padded.size(); i++)
+    {
+        const Eigen::Vector2d& a = padded[i];
+        const Eigen::Vector2d& b = padded[(i + 1) % padded.size()];
+
+        Eigen::Vector2d ab = b - a;
+        double t = std::max(0.0, std::min(1.0, -a.dot(ab) / ab.squaredNorm()));
+        radius = std::min(radius, (a + t*ab).norm());
+    }
+
+    return radius;
+}
+
+unsigned char MapLoader::computeCost(double distance)
+{
+    if(distance == 0)
+        return costmap_2d::LETHAL_OBSTACLE;
+    else if(distance * resolution <= inscribedRadius)
+        return costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+
+    double factor = std::exp(-1.0 * costScalingFactor * (distance * resolution - inscribedRadius));
+    return (costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1) * factor;
+}
+
+MapLoader::~MapLoader()
+{
+
+}
+
+}
@@ -0,0 +1,140 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/MapVersion.h"
+
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+
+namespace rrt_planning
+{
+
+MapVersion::MapVersion()
+{
+    sizeX = 0;
+    sizeY = 0;
+    resolution = 1;
+    invResolution = 1;
+    originX = 0;
+    originY = 0;
+
+    number = 0;
+    fullNumber = 0;
+}
+
+bool MapVersion::getChangedSince(unsigned int since, int& minX, int& minY, int& maxX, int& maxY) const
+{
+    minX = minY = maxX = maxY = 0;
+
+    if(since == number)
+        return true;
+
+    //Rebuilt from scratch, or changed too many times to know
+    if(since < fullNumber || since > number || history.empty() || history.front().number > since + 1)
+        return false;
+
+    for(auto& window : history)
+    {
+        if(window.number <= since || window.minX >= window.maxX || window.minY >= window.maxY)
+            continue;
+
+        if(minX >= maxX || minY >= maxY)
+        {
+            minX = window.minX;
+            minY = window.minY;
+            maxX = window.maxX;
+            maxY = window.maxY;
+        }
+        else
+        {
+            minX = std::min(minX, window.minX);
+            minY = std::min(minY, window.minY);
+            maxX = std::max(maxX, window.maxX);
+            maxY = std::max(maxY, window.maxY);
+        }
+    }
+
+    return true;
+}
+
+void MapVersion::resize(int sizeX, int sizeY)
+{
+    this->sizeX = sizeX;
+    this->sizeY = sizeY;
+
+    int words = (sizeX + 63) / 64;
+
+    costs.assign(sizeX, sizeY, 0);
+    freeBits.assign(words, sizeY, 0);
+    voronoiBits.assign(words, sizeY, 0);
+}
+
+void MapVersion::computeBits()
+{
+    computeBits(0, 0, sizeX, sizeY);
+}
+
+void MapVersion::computeBits(int minX, int minY, int maxX, int maxY)
+{
+    for(int y = minY; y < maxY; y++)
+    {
+        //Whole words, the cells of the window are recomputed with the rest of their word
+        for(int word = minX >> 6; word <= (maxX - 1) >> 6; word++)
+        {
+            uint64_t freeWord = 0;
+            uint64_t voronoiWord = 0;
+
+            int begin = word * 64;
+            int end = std::min(begin + 64, sizeX);
+
+            for(int x = begin; x < end; x++)
+            {
+                unsigned char cost = costs(x, y);
+                uint64_t bit = uint64_t(1) << (x - begin);
+
+                if(cost <= costmap_2d::FREE_SPACE)
+                    freeWord |= bit;
+
+                if(cost < costmap_2d::LETHAL_OBSTACLE)
+                    voronoiWord |= bit;
+            }
+
+            if(freeBits(word, y) != freeWord)
+                freeBits.at(word, y) = freeWord;
+
+            if(voronoiBits(word, y) != voronoiWord)
+                voronoiBits.at(word, y) = voronoiWord;
+        }
+    }
+}
+
+void MapVersion::addHistory(int minX, int minY, int maxX, int maxY)
+{
+    if(history.size() == HISTORY)
+        history.erase(history.begin());
+
+    Window window = {number, minX, minY, maxX, maxY};
+    history.push_back(window);
+}
+
+}
@@ -0,0 +1,276 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/MappedMap.h"
+#include "rrt_planning/utils/Stats.h"
+
+#include <costmap_2d/cost_values.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace rrt_planning
+{
+
+static const char MAGIC[8] = {'R', 'R', 'T', 'M', 'A', 'P', 0, 0};
+static const uint32_t FORMAT_VERSION = 1;
+static const uint64_t PAGE_ALIGNMENT = 4096;
+
+static uint64_t align(uint64_t offset)
+{
+    return (offset + PAGE_ALIGNMENT - 1) & ~(PAGE_ALIGNMENT - 1);
+}
+
+MappedMap::MappedMap(const std::string& filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("Cannot open " + filename);
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header))
+    {
+        ::close(fd);
+        throw std::runtime_error("Invalid map file " + filename);
+    }
+
+    length = info.st_size;
+    data = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(data == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + filename);
+
+    header = static_cast<const Header*>(data);
+
+    std::size_t tiles = static_cast<std::size_t>(header->tilesX) * header->tilesY;
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->formatVersion == FORMAT_VERSION && header->tileSize == TILE_SIZE &&
+                 header->costOffset + tiles * TILE_CELLS <= length &&
+                 header->freeOffset + tiles * TILE_SIZE * sizeof(uint64_t) <= length &&
+                 (header->clearanceOffset == 0 || header->clearanceOffset + tiles * TILE_CELLS * sizeof(float) <= length);
+
+    if(!valid)
+    {
+        munmap(data, length);
+        throw std::runtime_error("Invalid map file " + filename);
+    }
+
+    const unsigned char* base = static_cast<const unsigned char*>(data);
+    costs = base + header->costOffset;
+    freeBits = reinterpret_cast<const uint64_t*>(base + header->freeOffset);
+    clearance = header->clearanceOffset ? reinterpret_cast<const float*>(base + header->clearanceOffset) : nullptr;
+
+    bounds.minX = header->originX;
+    bounds.minY = header->originY;
+    bounds.maxX = header->originX + header->sizeX * header->resolution;
+    bounds.maxY = header->originY + header->sizeY * header->resolution;
+    bounds.minZ = 0;
+    bounds.maxZ = 0;
+}
+
+std::shared_ptr<MappedMap> MappedMap::open(const std::string& filename)
+{
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<MappedMap>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    std::shared_ptr<MappedMap> map = registry[filename].lock();
+    if(!map)
+    {
+        map = std::make_shared<MappedMap>(filename);
+        registry[filename] = map;
+    }
+
+    return map;
+}
+
+void MappedMap::write(const std::string& filename, int sizeX, int sizeY, double resolution,
+                      double originX, double originY, const unsigned char* costs, const float* clearance)
+{
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion = FORMAT_VERSION;
+    header.tileSize = TILE_SIZE;
+    header.sizeX = sizeX;
+    header.sizeY = sizeY;
+    header.tilesX = (sizeX + TILE_SIZE - 1) / TILE_SIZE;
+    header.tilesY = (sizeY + TILE_SIZE - 1) / TILE_SIZE;
+    header.resolution = resolution;
+    header.originX = originX;
+    header.originY = originY;
+
+    std::size_t tiles = static_cast<std::size_t>(header.tilesX) * header.tilesY;
+
+    //Cells of the border tiles outside the map are unknown
+    std::vector<unsigned char> tiledCosts(tiles * TILE_CELLS, costmap_2d::NO_INFORMATION);
+    std::vector<uint64_t> tiledFree(tiles * TILE_SIZE, 0);
+    std::vector<float> tiledClearance(clearance ? tiles * TILE_CELLS : 0, 0.0f);
+
+    for(int y = 0; y < sizeY; y++)
+    {
+        for(int x = 0; x < sizeX; x++)
+        {
+            std::size_t tile = static_cast<std::size_t>(y >> TILE_BITS) * header.tilesX + (x >> TILE_BITS);
+            int cell = ((y & (TILE_SIZE - 1)) << TILE_BITS) | (x & (TILE_SIZE - 1));
+            std::size_t index = static_cast<std::size_t>(y) * sizeX + x;
+
+            tiledCosts[tile * TILE_CELLS + cell] = costs[index];
+
+            if(costs[index] <= costmap_2d::FREE_SPACE)
+                tiledFree[tile * TILE_SIZE + (y & (TILE_SIZE - 1))] |= uint64_t(1) << (x & (TILE_SIZE - 1));
+
+            if(clearance)
+                tiledClearance[tile * TILE_CELLS + cell] = clearance[index];
+        }
+    }
+
+    header.costOffset = align(sizeof(Header));
+    header.freeOffset = align(header.costOffset + tiledCosts.size());
+    header.clearanceOffset = clearance ? align(header.freeOffset + tiledFree.size() * sizeof(uint64_t)) : 0;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file)
+        throw std::runtime_error("Cannot write " + filename);
+
+    auto writeAt = [&file](uint64_t offset, const void* buffer, std::size_t size)
+    {
+        std::vector<char> padding(offset - file.tellp(), 0);
+        file.write(padding.data(), padding.size());
+        file.write(static_cast<const char*>(buffer), size);
+    };
+
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.costOffset, tiledCosts.data(), tiledCosts.size());
+    writeAt(header.freeOffset, tiledFree.data(), tiledFree.size() * sizeof(uint64_t));
+
+    if(clearance)
+        writeAt(header.clearanceOffset, tiledClearance.data(), tiledClearance.size() * sizeof(float));
+
+    if(!file)
+        throw std::runtime_error("Cannot write " + filename);
+}
+
+bool MappedMap::isFree(const Eigen::VectorXd& p)
+{
+    Stats::count(Stats::MAP_IS_FREE);
+    int mx, my;
+    return worldToMap(p(0), p(1), mx, my) && isFreeCell(mx, my);
+}
+
+bool MappedMap::isVoronoiFree(const Eigen::VectorXd& p)
+{
+    return getCost(p) < costmap_2d::LETHAL_OBSTACLE;
+}
+
+unsigned char MappedMap::getCost(const Eigen::VectorXd& p)
+{
+    int mx, my;
+
+    if(worldToMap(p(0), p(1), mx, my))
+        return getCostCell(mx, my);
+    else
+        return costmap_2d::NO_INFORMATION;
+}
+
+bool MappedMap::insideBound(const Eigen::VectorXd& p)
+{
+    int mx, my;
+    return worldToMap(p(0), p(1), mx, my);
+}
+
+Eigen::VectorXd MappedMap::getOutsidePoint()
+{
+    Eigen::Vector3d p(bounds.maxX + 1.0, bounds.maxY + 1.0, 0);
+    return p;
+}
+
+bool MappedMap::getChangedBounds(Bounds& changed)
+{
+    //The file never changes
+    changed.minX = changed.maxX = bounds.minX;
+    changed.minY = changed.maxY = bounds.minY;
+    changed.minZ = changed.maxZ = 0;
+
+    return true;
+}
+
+bool MappedMap::reportsChanges()
+{
+    return true;
+}
+
+bool MappedMap::getGrid(GridGeometry& grid)
+{
+    grid.resolution = header->resolution;
+    grid.originX = header->originX;
+    grid.originY = header->originY;
+    grid.sizeX = header->sizeX;
+    grid.sizeY = header->sizeY;
+
+    return true;
+}
+
+bool MappedMap::isFreeGridCell(int mx, int my)
+{
+    return mx >= 0 && my >= 0 && mx < header->sizeX && my < header->sizeY && isFreeCell(mx, my);
+}
+
+void MappedMap::isFreeBatch(const Eigen::Matrix2Xd& points, bool* out)
+{
+    Stats::count(Stats::MAP_BATCH_POINTS, points.cols());
+
+    for(int i = 0; i < points.cols(); i++)
+    {
+        int mx, my;
+        out[i] = worldToMap(points(0, i), points(1, i), mx, my) && isFreeCell(mx, my);
+    }
+}
+
+double MappedMap::getClearance(const Eigen::VectorXd& p)
+{
+    int mx, my;
+
+    if(clearance && worldToMap(p(0), p(1), mx, my))
+        return clearance[tileIndex(mx, my) * TILE_CELLS + cellIndex(mx, my)];
+    else
+        return 0;
+}
+
+MappedMap::~MappedMap()
+{
+    munmap(data, length);
+}
+
+}
@@ -0,0 +1,532 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/ObstacleContours.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+//Directions of the lattice edges
+static const int DX[] = {1, 0, -1, 0};
+static const int DY[] = {0, 1, 0, -1};
+
+static inline double cross(const Vector2d& a, const Vector2d& b)
+{
+    return a(0) * b(1) - a(1) * b(0);
+}
+
+ObstacleContours::ObstacleContours()
+{
+    grid.resolution = 1;
+    grid.originX = grid.originY = 0;
+    grid.sizeX = grid.sizeY = 0;
+
+    polygons = 0;
+    bucketsX = bucketsY = 0;
+    stamp = 0;
+}
+
+bool ObstacleContours::build(Map& map, double tolerance)
+{
+    vertices.clear();
+    next.clear();
+    previous.clear();
+    convex.clear();
+    polygons = 0;
+
+    if(!map.getGrid(grid))
+    {
+        grid.sizeX = grid.sizeY = 0;
+        index();
+        return false;
+    }
+
+    //Blocked cells with a blocked ring around the map
+    int width = grid.sizeX + 2;
+    std::vector<char> blocked(static_cast<std::size_t>(width) * (grid.sizeY + 2), 1);
+
+    for(int y = 0; y < grid.sizeY; y++)
+        for(int x = 0; x < grid.sizeX; x++)
+            blocked[static_cast<std::size_t>(y + 1) * width + x + 1] = !map.isFreeGridCell(x, y);
+
+    trace(blocked, tolerance / grid.resolution);
+    index();
+
+    return true;
+}
+
+void ObstacleContours::intersect(const Vector2d& a, const Vector2d& b, std::vector<Crossing>& crossings)
+{
+    crossings.clear();
+    collect(a, b, 0);
+
+    Vector2d d = b - a;
+
+    for(int edge : candidates)
+    {
+        double t;
+        if(!crosses(edge, a, d, t))
+            continue;
+
+        //The obstacle lies on the left of the edge
+        Vector2d e = vertices[next[edge]] - vertices[edge];
+        Crossing crossing = {t, cross(e, d) > 0, edge};
+        crossings.push_back(crossing);
+    }
+
+    std::sort(crossings.begin(), crossings.end(), [](const Crossing& c1, const Crossing& c2)
+    {
+        return c1.t < c2.t || (c1.t == c2.t && c1.entering && !c2.entering);
+    });
+}
+
+bool ObstacleContours::isClear(const Vector2d& a, const Vector2d& b) const
+{
+    //Buckets visited row by row in the direction of the segment, to stop at the first crossing
+    double scale = 1.0 / (grid.resolution * BUCKET_SIZE);
+    Vector2d origin(grid.originX, grid.originY);
+    Vector2d pa = (a - origin) * scale;
+    Vector2d pb = (b - origin) * scale;
+    Vector2d d = pb - pa;
+
+    int rowA = std::min(bucketsY - 1, std::max(0, static_cast<int>(std::floor(pa(1)))));
+    int rowB = std::min(bucketsY - 1, std::max(0, static_cast<int>(std::floor(pb(1)))));
+    int stepY = (rowB >= rowA) ? 1 : -1;
+
+    for(int by = rowA; by != rowB + stepY; by += stepY)
+    {
+        double t0 = 0;
+        double t1 = 1;
+
+        if(d(1) != 0)
+        {
+            double s0 = (by - pa(1)) / d(1);
+            double s1 = (by + 1 - pa(1)) / d(1);
+            t0 = std::max(t0, std::min(s0, s1));
+            t1 = std::min(t1, std::max(s0, s1));
+
+            if(t0 > t1)
+                continue;
+        }
+
+        int columnA = std::min(bucketsX - 1, std::max(0, static_cast<int>(std::floor(pa(0) + t0 * d(0)))));
+        int columnB = std::min(bucketsX - 1, std::max(0, static_cast<int>(std::floor(pa(0) + t1 * d(0)))));
+        int stepX = (columnB >= columnA) ? 1 : -1;
+
+        for(int bx = columnA; bx != columnB + stepX; bx += stepX)
+        {
+            std::size_t bucket = static_cast<std::size_t>(by) * bucketsX + bx;
+
+            for(int i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++)
+            {
+                double t;
+                if(crosses(bucketEdges[i], a, b - a, t))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+double ObstacleContours::leave(const Vector2d& origin, const Vector2d& direction) const
+{
+    double minX = grid.originX;
+    double minY = grid.originY;
+    double maxX = grid.originX + grid.sizeX * grid.resolution;
+    double maxY = grid.originY + grid.sizeY * grid.resolution;
+
+    if(origin(0) < minX || origin(1) < minY || origin(0) >= maxX || origin(1) >= maxY)
+        return 0;
+
+    double t = std::numeric_limits<double>::infinity();
+
+    if(direction(0) > 0)
+        t = std::min(t, (maxX - origin(0)) / direction(0));
+    else if(direction(0) < 0)
+        t = std::min(t, (minX - origin(0)) / direction(0));
+
+    if(direction(1) > 0)
+        t = std::min(t, (maxY - origin(1)) / direction(1));
+    else if(direction(1) < 0)
+        t = std::min(t, (minY - origin(1)) / direction(1));
+
+    return std::isinf(t) ? 0 : t;
+}
+
+bool ObstacleContours::isCorner(const Vector2d& p, double radius)
+{
+    collect(p, p, radius);
+
+    bool empty = true;
+
+    for(int i : candidates)
+    {
+        const Vector2d& v = vertices[i];
+        const Vector2d& w = vertices[next[i]];
+
+        //Distance from the edge
+        Vector2d e = w - v;
+        double s = std::max(0.0, std::min(1.0, e.dot(p - v) / e.squaredNorm()));
+        if((v + s*e - p).norm() <= radius)
+            empty = false;
+
+        if(!convex[i] || (v - p).norm() > radius)
+            continue;
+
+        //Both edges of the vertex must face the point, their free side is on the right
+        Vector2d in = v - vertices[previous[i]];
+        Vector2d out = w - v;
+        Vector2d d = p - v;
+
+        if(cross(in, d) <= 0 && cross(out, d) <= 0)
+            return true;
+    }
+
+    return empty;
+}
+
+bool ObstacleContours::crosses(int edge, const Vector2d& a, const Vector2d& d, double& t) const
+{
+    const Vector2d& p = vertices[edge];
+    const Vector2d& q = vertices[next[edge]];
+
+    //Vertices on the line count on its left, so a ray through a vertex crosses once or twice
+    bool sideP = cross(d, p - a) >= 0;
+    bool sideQ = cross(d, q - a) >= 0;
+
+    if(sideP == sideQ)
+        return false;
+
+    Vector2d e = q - p;
+    double denominator = cross(d, e);
+
+    if(denominator == 0)
+        return false;
+
+    t = cross(p - a, e) / denominator;
+
+    return t > 0 && t <= 1;
+}
+
+void ObstacleContours::trace(const std::vector<char>& blocked, double tolerance)
+{
+    int width = grid.sizeX + 2;
+    auto isBlocked = [&](int x, int y)
+    {
+        return blocked[static_cast<std::size_t>(y + 1) * width + x + 1] != 0;
+    };
+
+    //Edges between a free cell and a blocked one, keyed by their first lattice point
+    int lattice = grid.sizeX + 1;
+    std::vector<uint64_t> edges;
+
+    for(int y = 0; y < grid.sizeY; y++)
+    {
+        for(int x = 0; x < grid.sizeX; x++)
+        {
+            if(isBlocked(x, y))
+                continue;
+
+            //Walking along each edge the blocked cell is on the left
+            int starts[4][3] = {{x + 1, y + 1, 3}, {x, y, 1}, {x, y + 1, 0}, {x + 1, y, 2}};
+            bool sides[4] = {isBlocked(x + 1, y), isBlocked(x - 1, y), isBlocked(x, y + 1), isBlocked(x, y - 1)};
+
+            for(int i = 0; i < 4; i++)
+            {
+                if(!sides[i])
+                    continue;
+
+                uint64_t point = static_cast<uint64_t>(starts[i][1]) * lattice + starts[i][0];
+                edges.push_back((point << 2) | starts[i][2]);
+            }
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    std::vector<bool> visited(edges.size(), false);
+
+    std::vector<Vector2i> loop;
+
+    for(std::size_t first = 0; first < edges.size(); first++)
+    {
+        if(visited[first])
+            continue;
+
+        loop.clear();
+        std::size_t current = first;
+        int previousDirection = -1;
+
+        while(!visited[current])
+        {
+            visited[current] = true;
+
+            uint64_t point = edges[current] >> 2;
+            int direction = edges[current] & 3;
+            int x = point % lattice;
+            int y = point / lattice;
+
+            //Only the turns are vertices of the polygon
+            if(direction != previousDirection)
+                loop.push_back(Vector2i(x, y));
+
+            previousDirection = direction;
+
+            //At a saddle turn left, so that diagonal obstacles stay apart
+            uint64_t end = static_cast<uint64_t>(y + DY[direction]) * lattice + x + DX[direction];
+            auto range = std::equal_range(edges.begin(), edges.end(), end << 2,
+                                          [](uint64_t e1, uint64_t e2)
+            {
+                return (e1 >> 2) < (e2 >> 2);
+            });
+
+            std::size_t chosen = range.first - edges.begin();
+            for(auto it = range.first; it != range.second; it++)
+            {
+                if(static_cast<int>(*it & 3) == (direction + 1) % 4)
+                    chosen = it - edges.begin();
+            }
+
+            current = chosen;
+        }
+
+        //The first vertex is not a turn when the loop ends in its direction
+        if(loop.size() > 1 && (edges[first] & 3) == static_cast<uint64_t>(previousDirection))
+            loop.erase(loop.begin());
+
+        simplify(loop, tolerance);
+        addPolygon(loop);
+    }
+}
+
+void ObstacleContours::simplify(std::vector<Vector2i>& loop, double tolerance) const
+{
+    if(tolerance <= 0 || loop.size() <= 4)
+        return;
+
+    //Split the loop at the vertex farthest from the first one
+    int n = loop.size();
+    int far = 0;
+    for(int i = 1; i < n; i++)
+        if((loop[i] - loop[0]).squaredNorm() > (loop[far] - loop[0]).squaredNorm())
+            far = i;
+
+    std::vector<bool> keep(n + 1, false);
+    keep[0] = keep[far] = keep[n] = true;
+
+    std::vector<Vector2i> closed(loop);
+    closed.push_back(loop[0]);
+
+    simplify(closed, 0, far, tolerance, keep);
+    simplify(closed, far, n, tolerance, keep);
+
+    std::vector<Vector2i> simplified;
+    for(int i = 0; i < n; i++)
+        if(keep[i])
+            simplified.push_back(loop[i]);
+
+    //Degenerate polygons keep their exact shape
+    if(simplified.size() >= 3)
+        loop.swap(simplified);
+}
+
+void ObstacleContours::simplify(const std::vector<Vector2i>& loop, int first, int last, double tolerance,
+                                std::vector<bool>& keep) const
+{
+    Vector2d a = loop[first].cast<double>();
+    Vector2d b = loop[last].cast<double>();
+    Vector2d d = b - a;
+    double length = d.norm();
+
+    int farthest = -1;
+    double maxDistance = tolerance;
+
+    for(int i = first + 1; i < last; i++)
+    {
+        Vector2d p = loop[i].cast<double>();
+        double distance = (length > 0) ? std::fabs(cross(d, p - a)) / length : (p - a).norm();
+
+        if(distance > maxDistance)
+        {
+            maxDistance = distance;
+            farthest = i;
+        }
+    }
+
+    if(farthest < 0)
+        return;
+
+    keep[farthest] = true;
+    simplify(loop, first, farthest, tolerance, keep);
+    simplify(loop, farthest, last, tolerance, keep);
+}
+
+void ObstacleContours::addPolygon(const std::vector<Vector2i>& loop)
+{
+    int first = vertices.size();
+    int n = loop.size();
+
+    for(int i = 0; i < n; i++)
+    {
+        vertices.push_back(Vector2d(grid.originX + loop[i](0) * grid.resolution,
+                                    grid.originY + loop[i](1) * grid.resolution));
+        next.push_back(first + (i + 1) % n);
+        previous.push_back(first + (i + n - 1) % n);
+    }
+
+    //Left turns are the convex corners of the obstacle
+    for(int i = first; i < first + n; i++)
+    {
+        Vector2d in = vertices[i] - vertices[previous[i]];
+        Vector2d out = vertices[next[i]] - vertices[i];
+        convex.push_back(cross(in, out) > 0);
+    }
+
+    polygons++;
+}
+
+void ObstacleContours::index()
+{
+    //The lattice points on the far borders belong to the last buckets
+    bucketsX = grid.sizeX / BUCKET_SIZE + 1;
+    bucketsY = grid.sizeY / BUCKET_SIZE + 1;
+
+    std::size_t buckets = static_cast<std::size_t>(bucketsX) * bucketsY;
+    bucketStart.assign(buckets + 1, 0);
+
+    double scale = 1.0 / (grid.resolution * BUCKET_SIZE);
+    auto forEachBucket = [&](int edge, std::function<void(std::size_t)> f)
+    {
+        Vector2d origin(grid.originX, grid.originY);
+        Vector2d a = (vertices[edge] - origin) * scale;
+        Vector2d b = (vertices[next[edge]] - origin) * scale;
+        Vector2d d = b - a;
+
+        int minX = std::max(0, static_cast<int>(std::floor(std::min(a(0), b(0)))));
+        int maxX = std::min(bucketsX - 1, static_cast<int>(std::floor(std::max(a(0), b(0)))));
+        int minY = std::max(0, static_cast<int>(std::floor(std::min(a(1), b(1)))));
+        int maxY = std::min(bucketsY - 1, static_cast<int>(std::floor(std::max(a(1), b(1)))));
+
+        for(int by = minY; by <= maxY; by++)
+        {
+            for(int bx = minX; bx <= maxX; bx++)
+            {
+                //Skip the buckets of the bounding box that the edge misses
+                double s[4] = {cross(d, Vector2d(bx, by) - a), cross(d, Vector2d(bx + 1, by) - a),
+                               cross(d, Vector2d(bx, by + 1) - a), cross(d, Vector2d(bx + 1, by + 1) - a)};
+
+                if(std::min({s[0], s[1], s[2], s[3]}) > 0 || std::max({s[0], s[1], s[2], s[3]}) < 0)
+                    continue;
+
+                f(static_cast<std::size_t>(by) * bucketsX + bx);
+            }
+        }
+    };
+
+    for(int edge = 0; edge < static_cast<int>(vertices.size()); edge++)
+        forEachBucket(edge, [&](std::size_t bucket) { bucketStart[bucket + 1]++; });
+
+    for(std::size_t i = 0; i < buckets; i++)
+        bucketStart[i + 1] += bucketStart[i];
+
+    std::vector<int> fill(bucketStart.begin(), bucketStart.end() - 1);
+    bucketEdges.resize(bucketStart.back());
+
+    for(int edge = 0; edge < static_cast<int>(vertices.size()); edge++)
+        forEachBucket(edge, [&](std::size_t bucket) { bucketEdges[fill[bucket]++] = edge; });
+
+    stamps.assign(vertices.size(), 0);
+    stamp = 0;
+}
+
+void ObstacleContours::collect(const Vector2d& a, const Vector2d& b, double radius)
+{
+    candidates.clear();
+
+    if(++stamp == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+
+    //Bucket rows crossed by the segment grown by radius
+    double scale = 1.0 / (grid.resolution * BUCKET_SIZE);
+    Vector2d origin(grid.originX, grid.originY);
+    Vector2d pa = (a - origin) * scale;
+    Vector2d pb = (b - origin) * scale;
+    Vector2d d = pb - pa;
+    double r = radius * scale;
+
+    int minRow = std::max(0, static_cast<int>(std::floor(std::min(pa(1), pb(1)) - r)));
+    int maxRow = std::min(bucketsY - 1, static_cast<int>(std::floor(std::max(pa(1), pb(1)) + r)));
+
+    for(int by = minRow; by <= maxRow; by++)
+    {
+        //Part of the segment close enough to the row
+        double t0 = 0;
+        double t1 = 1;
+
+        if(d(1) != 0)
+        {
+            double s0 = (by - r - pa(1)) / d(1);
+            double s1 = (by + 1 + r - pa(1)) / d(1);
+            t0 = std::max(t0, std::min(s0, s1));
+            t1 = std::min(t1, std::max(s0, s1));
+
+            if(t0 > t1)
+                continue;
+        }
+
+        double x0 = pa(0) + t0 * d(0);
+        double x1 = pa(0) + t1 * d(0);
+
+        int minX = std::max(0, static_cast<int>(std::floor(std::min(x0, x1) - r)));
+        int maxX = std::min(bucketsX - 1, static_cast<int>(std::floor(std::max(x0, x1) + r)));
+
+        for(int bx = minX; bx <= maxX; bx++)
+        {
+            std::size_t bucket = static_cast<std::size_t>(by) * bucketsX + bx;
+
+            for(int i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++)
+            {
+                int edge = bucketEdges[i];
+
+                if(stamps[edge] != stamp)
+                {
+                    stamps[edge] = stamp;
+                    candidates.push_back(edge);
+                }
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,267 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/OccupancyPyramid.h"
+#include "rrt_planning/map/MapVersion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rrt_planning
+{
+
+OccupancyPyramid::OccupancyPyramid()
+{
+}
+
+void OccupancyPyramid::update(const MapVersion& map)
+{
+    int sizeX = map.getSizeX();
+    int sizeY = map.getSizeY();
+
+    levels.clear();
+
+    while(true)
+    {
+        levels.push_back(TiledLayer<unsigned char>());
+        levels.back().assign(sizeX, sizeY, 0);
+
+        if(sizeX <= 1 && sizeY <= 1)
+            break;
+
+        sizeX = (sizeX + 1) / 2;
+        sizeY = (sizeY + 1) / 2;
+    }
+
+    update(map, 0, 0, levels[0].getSizeX(), levels[0].getSizeY());
+}
+
+void OccupancyPyramid::update(const MapVersion& map, int minX, int minY, int maxX, int maxY)
+{
+    if(levels.empty() || map.getSizeX() != levels[0].getSizeX() || map.getSizeY() != levels[0].getSizeY())
+    {
+        update(map);
+        return;
+    }
+
+    for(int y = minY; y < maxY; y++)
+        for(int x = minX; x < maxX; x++)
+            set(0, x, y, !map.isFreeCell(x, y));
+
+    //Propagate the changed window up to the top level
+    for(int level = 1; level < getLevels(); level++)
+    {
+        minX = minX / 2;
+        minY = minY / 2;
+        maxX = (maxX + 1) / 2;
+        maxY = (maxY + 1) / 2;
+
+        pool(level, minX, minY, maxX, maxY);
+    }
+}
+
+void OccupancyPyramid::pool(int level, int minX, int minY, int maxX, int maxY)
+{
+    const TiledLayer<unsigned char>& child = levels[level - 1];
+    int childX = child.getSizeX();
+    int childY = child.getSizeY();
+
+    for(int y = minY; y < maxY; y++)
+    {
+        for(int x = minX; x < maxX; x++)
+        {
+            unsigned char blocked = (2*x + 1 >= childX) || (2*y + 1 >= childY);
+
+            for(int dy = 0; dy < 2 && !blocked; dy++)
+                for(int dx = 0; dx < 2 && !blocked; dx++)
+                    blocked = child(2*x + dx, 2*y + dy);
+
+            set(level, x, y, blocked);
+        }
+    }
+}
+
+bool OccupancyPyramid::isCorridorFree(const Eigen::Vector2d& a, const Eigen::Vector2d& b, double radius) const
+{
+    if(levels.empty())
+        return false;
+
+    //The corridor must lie inside the map
+    Eigen::Vector2d min = a.cwiseMin(b).array() - radius;
+    Eigen::Vector2d max = a.cwiseMax(b).array() + radius;
+
+    if(min(0) < 0 || min(1) < 0 || max(0) >= levels[0].getSizeX() || max(1) >= levels[0].getSizeY())
+        return false;
+
+    int level, minX, minY, maxX, maxY;
+    getRoots(min, max, level, minX, minY, maxX, maxY);
+
+    for(int by = minY; by <= maxY; by++)
+        for(int bx = minX; bx <= maxX; bx++)
+            if(!isCorridorFree(level, bx, by, a, b, radius))
+                return false;
+
+    return true;
+}
+
+double OccupancyPyramid::freeFraction(const Eigen::Vector2d& a, const Eigen::Vector2d& b, double radius) const
+{
+    if(levels.empty())
+        return 0;
+
+    Eigen::Vector2d min = a.cwiseMin(b).array() - radius;
+    Eigen::Vector2d max = a.cwiseMax(b).array() + radius;
+
+    if(min(0) < 0 || min(1) < 0 || max(0) >= levels[0].getSizeX() || max(1) >= levels[0].getSizeY())
+        return 0;
+
+    int level, minX, minY, maxX, maxY;
+    getRoots(min, max, level, minX, minY, maxX, maxY);
+
+    double first = 2;
+
+    for(int by = minY; by <= maxY; by++)
+        for(int bx = minX; bx <= maxX; bx++)
+            first = firstBlocked(level, bx, by, a, b, radius, first);
+
+    return first;
+}
+
+void OccupancyPyramid::getRoots(const Eigen::Vector2d& min, const Eigen::Vector2d& max,
+                                int& level, int& minX, int& minY, int& maxX, int& maxY) const
+{
+    //Lowest level where at most 2x2 blocks cover the box, instead of descending from the top.
+    //The cells that only touch the low sides of the box are included, as the slab test does
+    int x0 = std::max(0, static_cast<int>(std::ceil(min(0))) - 1);
+    int y0 = std::max(0, static_cast<int>(std::ceil(min(1))) - 1);
+    int x1 = max(0);
+    int y1 = max(1);
+
+    level = 0;
+
+    while((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)
+        level++;
+
+    minX = x0 >> level;
+    minY = y0 >> level;
+    maxX = x1 >> level;
+    maxY = y1 >> level;
+}
+
+bool OccupancyPyramid::isCorridorFree(int level, int bx, int by, const Eigen::Vector2d& a,
+                                      const Eigen::Vector2d& b, double radius) const
+{
+    double t0;
+
+    if(!intersects(level, bx, by, a, b, radius, t0) || !isBlocked(level, bx, by))
+        return true;
+
+    if(level == 0)
+        return false;
+
+    //Children outside the map cannot touch a corridor inside it
+    for(int dy = 0; dy < 2; dy++)
+    {
+        for(int dx = 0; dx < 2; dx++)
+        {
+            int cx = 2*bx + dx;
+            int cy = 2*by + dy;
+
+            if(cx < levels[level - 1].getSizeX() && cy < levels[level - 1].getSizeY() &&
+                    !isCorridorFree(level - 1, cx, cy, a, b, radius))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+double OccupancyPyramid::firstBlocked(int level, int bx, int by, const Eigen::Vector2d& a,
+                                      const Eigen::Vector2d& b, double radius, double first) const
+{
+    double t0;
+
+    if(!intersects(level, bx, by, a, b, radius, t0) || t0 >= first || !isBlocked(level, bx, by))
+        return first;
+
+    if(level == 0)
+        return t0;
+
+    //Visit the children in the direction of the segment, so that the later ones are pruned
+    int flipX = b(0) < a(0);
+    int flipY = b(1) < a(1);
+
+    for(int dy = 0; dy < 2; dy++)
+    {
+        for(int dx = 0; dx < 2; dx++)
+        {
+            int cx = 2*bx + (dx ^ flipX);
+            int cy = 2*by + (dy ^ flipY);
+
+            if(cx < levels[level - 1].getSizeX() && cy < levels[level - 1].getSizeY())
+                first = firstBlocked(level - 1, cx, cy, a, b, radius, first);
+        }
+    }
+
+    return first;
+}
+
+bool OccupancyPyramid::intersects(int level, int bx, int by, const Eigen::Vector2d& a,
+                                  const Eigen::Vector2d& b, double radius, double& t0) const
+{
+    //Slab test of the segment against the block grown by radius
+    double size = 1 << level;
+    Eigen::Vector2d min(bx*size - radius, by*size - radius);
+    Eigen::Vector2d max((bx + 1)*size + radius, (by + 1)*size + radius);
+    Eigen::Vector2d d = b - a;
+
+    t0 = 0;
+    double t1 = 1;
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(d(i) == 0)
+        {
+            if(a(i) < min(i) || a(i) > max(i))
+                return false;
+        }
+        else
+        {
+            double tMin = (min(i) - a(i)) / d(i);
+            double tMax = (max(i) - a(i)) / d(i);
+
+            if(tMin > tMax)
+                std::swap(tMin, tMax);
+
+            t0 = std::max(t0, tMin);
+            t1 = std::min(t1, tMax);
+
+            if(t0 > t1)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+}
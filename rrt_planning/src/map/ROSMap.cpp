@@ -22,6 +22,7 @@
  */
 
 #include "rrt_planning/map/ROSMap.h"
+#include "rrt_planning/utils/Stats.h"
 
 #include <costmap_2d/cost_values.h>
 
@@ -49,6 +50,7 @@ ROSMap::ROSMap(costmap_2d::Costmap2DROS* costmap_ros) : costmap_ros(costmap_ros)
 
 bool ROSMap::isFree(const Eigen::VectorXd& p)
 {
+    Stats::count(Stats::MAP_IS_FREE);
     return getCost(p) <= costmap_2d::FREE_SPACE;
 }
 
@@ -95,6 +97,26 @@ Eigen::VectorXd ROSMap::getOutsidePoint()
     return p;
 }
 
+bool ROSMap::getGrid(GridGeometry& grid)
+{
+    grid.resolution = costmap->getResolution();
+    grid.originX = costmap->getOriginX();
+    grid.originY = costmap->getOriginY();
+    grid.sizeX = costmap->getSizeInCellsX();
+    grid.sizeY = costmap->getSizeInCellsY();
+
+    return true;
+}
+
+bool ROSMap::isFreeGridCell(int mx, int my)
+{
+    if(mx < 0 || my < 0 || mx >= static_cast<int>(costmap->getSizeInCellsX()) ||
+       my >= static_cast<int>(costmap->getSizeInCellsY()))
+        return false;
+
+    return costmap->getCost(mx, my) <= costmap_2d::FREE_SPACE;
+}
+
 ROSMap::~ROSMap()
 {
 
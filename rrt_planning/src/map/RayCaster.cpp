@@ -0,0 +1,210 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/RayCaster.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+RayCaster::RayCaster(Map& map) : map(map), gridded(false), tMax(0), nudge(0), mx(0), my(0),
+    previous(0), entry(0), exit(0), seeded(true), stepX(0), stepY(0), tMaxX(0), tMaxY(0),
+    tDeltaX(0), tDeltaY(0)
+{
+    grid.resolution = 1;
+    grid.originX = grid.originY = 0;
+    grid.sizeX = grid.sizeY = 0;
+}
+
+void RayCaster::start(const Vector2d& origin, const Vector2d& direction, double tMax, double resolution)
+{
+    gridded = map.getGrid(grid);
+
+    if(!gridded)
+    {
+        grid.resolution = resolution;
+        grid.originX = grid.originY = 0;
+        grid.sizeX = grid.sizeY = 0;
+    }
+
+    this->origin = origin;
+    this->direction = direction;
+    this->tMax = tMax;
+
+    //Points a thousandth of a cell away from a border are inside the cell
+    double length = direction.norm() / grid.resolution;
+    nudge = (length > 0) ? 1e-3 / length : 0;
+
+    seed(0);
+}
+
+bool RayCaster::next()
+{
+    if(exit >= tMax)
+        return false;
+
+    Stats::count(Stats::MAP_RAY_STEPS);
+
+    previous = entry;
+    entry = exit;
+    seeded = false;
+
+    //A ray through a corner moves diagonally, as the corner belongs to that cell
+    if(tMaxX < tMaxY)
+    {
+        mx += stepX;
+        tMaxX += tDeltaX;
+    }
+    else if(tMaxY < tMaxX)
+    {
+        my += stepY;
+        tMaxY += tDeltaY;
+    }
+    else
+    {
+        mx += stepX;
+        my += stepY;
+        tMaxX += tDeltaX;
+        tMaxY += tDeltaY;
+    }
+
+    exit = std::min(std::min(tMaxX, tMaxY), tMax);
+
+    return true;
+}
+
+bool RayCaster::skipFree()
+{
+    double length = direction.norm();
+
+    if(length == 0)
+        return false;
+
+    //Samples one cell apart from the middle of the ray in the current cell
+    double t = getMiddle();
+    Vector2d delta = direction * (grid.resolution / length);
+    int steps = map.freeSteps(getPoint(t), delta);
+
+    if(steps < 1)
+        return false;
+
+    //Stop short of the last sample, that may lie on the border of a blocked cell
+    t = std::min(t + steps * grid.resolution / length - 2*nudge, tMax);
+
+    if(t <= exit)
+        return false;
+
+    //The free samples are measured inside the map only
+    Vector2d p = getPoint(t);
+    if(gridded)
+    {
+        double cx = std::floor((p(0) - grid.originX) / grid.resolution);
+        double cy = std::floor((p(1) - grid.originY) / grid.resolution);
+
+        if(cx < 0 || cy < 0 || cx >= grid.sizeX || cy >= grid.sizeY ||
+           !map.isFreeGridCell(static_cast<int>(cx), static_cast<int>(cy)))
+            return false;
+    }
+    else
+    {
+        VectorXd q = p;
+        if(!map.insideBound(q) || !map.isFree(q))
+            return false;
+    }
+
+    seed(t);
+
+    return true;
+}
+
+bool RayCaster::isFree()
+{
+    if(gridded)
+        return map.isFreeGridCell(mx, my);
+
+    VectorXd p = getPoint(getMiddle());
+    return map.isFree(p);
+}
+
+bool RayCaster::isInside()
+{
+    if(gridded)
+        return mx >= 0 && my >= 0 && mx < grid.sizeX && my < grid.sizeY;
+
+    VectorXd p = getPoint(getMiddle());
+    return map.insideBound(p);
+}
+
+Vector2d RayCaster::getEntryPoint() const
+{
+    if(seeded)
+        return getPoint(entry);
+
+    return getPoint((entry + nudge < exit) ? entry + nudge : (entry + exit) / 2);
+}
+
+Vector2d RayCaster::getBeforePoint() const
+{
+    if(seeded)
+        return getPoint(entry);
+
+    return getPoint((entry - nudge > previous) ? entry - nudge : (previous + entry) / 2);
+}
+
+void RayCaster::seed(double t)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+
+    //Traversal in cell units, with the same rounding as the map
+    double cx = (origin(0) + t*direction(0) - grid.originX) / grid.resolution;
+    double cy = (origin(1) + t*direction(1) - grid.originY) / grid.resolution;
+    double dx = direction(0) / grid.resolution;
+    double dy = direction(1) / grid.resolution;
+
+    mx = static_cast<int>(std::floor(cx));
+    my = static_cast<int>(std::floor(cy));
+
+    stepX = (dx > 0) ? 1 : ((dx < 0) ? -1 : 0);
+    stepY = (dy > 0) ? 1 : ((dy < 0) ? -1 : 0);
+
+    tDeltaX = (stepX != 0) ? stepX / dx : inf;
+    tDeltaY = (stepY != 0) ? stepY / dy : inf;
+
+    tMaxX = (stepX != 0) ? t + ((stepX > 0 ? mx + 1 : mx) - cx) / dx : inf;
+    tMaxY = (stepY != 0) ? t + ((stepY > 0 ? my + 1 : my) - cy) / dy : inf;
+
+    previous = entry = t;
+    exit = std::min(std::min(tMaxX, tMaxY), tMax);
+    seeded = true;
+}
+
+double RayCaster::getMiddle() const
+{
+    return std::isinf(exit) ? entry : (entry + exit) / 2;
+}
+
+}
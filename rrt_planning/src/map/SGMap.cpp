@@ -1,4 +1,5 @@
 #include "rrt_planning/map/SGMap.h"
+#include "rrt_planning/utils/Stats.h"
 
 using namespace std;
 using namespace Eigen;
@@ -6,7 +7,7 @@ using namespace Eigen;
 namespace rrt_planning
 {
 
-SGMap::SGMap(Map& map) : map(map) {}
+SGMap::SGMap(Map& map) : map(map), caster(map), contoursReady(false) {}
 
 void SGMap::initialize(ros::NodeHandle& nh)
 {
@@ -18,68 +19,107 @@ void SGMap::initialize(ros::NodeHandle& nh)
     nh.param("ray", ray, 0.3);
     nh.param("corner_step", corner_step, 0.1);
     nh.param("k_los", k_los, 2);
+    nh.param("contours", use_contours, false);
+    nh.param("contour_tolerance", contour_tolerance, 0.0);
+
+    //Segments between the same states, up to rounding noise, share an entry
+    int segment_cache;
+    nh.param("segment_cache", segment_cache, 4096);
+    cache.initialize(segment_cache, 1e-6);
+
+    //Circle of radius ray sampled at angles i*delta, i in [0, discretization]
+    double delta = 2*M_PI / discretization;
+    circle.resize(2, discretization + 1);
+    for(int i = 0; i <= discretization; i++)
+    {
+        circle(0, i) = ray*cos(i*delta);
+        circle(1, i) = ray*sin(i*delta);
+    }
+
+    cornerSamples.resize(2, discretization + 1);
+    cornerFree.resize(discretization + 1);
+}
+
+void SGMap::update()
+{
+    //Everything derived from the map is stale when it changed, or may have
+    Bounds changed;
+    bool known = map.getChangedBounds(changed);
+    bool modified = !known || (changed.minX < changed.maxX && changed.minY < changed.maxY);
+
+    if(modified)
+        cache.clear();
+
+    if(use_contours && (modified || !contoursReady))
+        contoursReady = contours.build(map, contour_tolerance);
 }
 
 
 bool SGMap::collisionPoints(const VectorXd& a, const VectorXd& b, vector<VectorXd>& actions)
+{
+    Stats::count(Stats::SG_COLLISION);
+    StatsTimer timer(Stats::SG_COLLISION_TIME);
+
+    const SegmentCache::Entry* entry = cache.find(a.head<2>(), b.head<2>());
+
+    if(entry)
+    {
+        actions.clear();
+        for(int i = 0; i < entry->points; i++)
+        {
+            Vector2d p(entry->x[i], entry->y[i]);
+            actions.push_back(entry->fromEnd[i] ? b : withPosition(a, p));
+        }
+
+        return entry->result;
+    }
+
+    bool result = traceSegment(a, b, actions);
+    cache.insert(a.head<2>(), b.head<2>(), result, actions, b);
+
+    return result;
+}
+
+bool SGMap::traceSegment(const VectorXd& a, const VectorXd& b, vector<VectorXd>& actions)
 {
     actions.clear();
     VectorXd tmp, exit_point;
     exit_point = b;
 
-    double DX = b(0) - a(0);
-    double DY = b(1) - a(1);
-
-    double norm = sqrt(pow(DX, 2) + pow(DY, 2));
-    double dx = (DX / norm) * step;
-    double dy = (DY / norm) * step;
-    int x_steps = DX / dx;
-
-    VectorXd p = a;
-    VectorXd old = a;
-    bool curr, prev;
-    curr = prev = map.isFree(p);
+    bool curr;
+    Vector2d before, entry;
+    startRay(a.head<2>(), b.head<2>() - a.head<2>(), 1.0);
 
-    for(int i = 0; i < x_steps; i++)
+    while(nextChange(curr, before, entry))
     {
-        old = p;
-        p(0) += dx;
-        p(1) += dy;
-        curr = map.isFree(p);
-
-        if(curr != prev)
+        if(actions.empty())
         {
-            if(actions.empty())
+            tmp = withPosition(a, before);
+            actions.push_back(tmp);
+        }
+        else
+        {
+            if(curr)
             {
-                actions.push_back(old);
-                tmp = old;
+                exit_point = withPosition(a, entry);
+                double distance = sqrt(pow(exit_point(0) - tmp(0), 2) + pow(exit_point(1) - tmp(1), 2));
+                if(distance > micro)
+                {
+                    actions.push_back(exit_point);
+                    return false;
+                }
             }
             else
             {
-                if(curr)
+                tmp = withPosition(a, before);
+                double distance = sqrt(pow(exit_point(0) - tmp(0), 2) + pow(exit_point(1) - tmp(1), 2));
+                if(distance > macro)
                 {
-                    exit_point = p;
-                    double distance = sqrt(pow(exit_point(0) - tmp(0), 2) + pow(exit_point(1) - tmp(1), 2));
-                    if(distance > micro)
-                    {
-                        actions.push_back(exit_point);
-                        return false;
-                    }
-                }
-                else
-                {
-                    tmp = old;
-                    double distance = sqrt(pow(exit_point(0) - tmp(0), 2) + pow(exit_point(1) - tmp(1), 2));
-                    if(distance > macro)
-                    {
-                        actions.push_back(exit_point);
-                        return false;
-                    }
+                    actions.push_back(exit_point);
+                    return false;
                 }
             }
-
         }
-        prev = curr;
     }
 
     if(actions.size() == 1)
@@ -93,44 +133,17 @@ bool SGMap::collisionPoints(const VectorXd& a, const VectorXd& b, vector<VectorX
 
 VectorXd SGMap::exitPoint(const VectorXd& current, const VectorXd& middle, bool cw)
 {
-    Vector3d c_point(current(0), current(1), 1);
-    Vector3d m_point(middle(0), middle(1), 1);
-    Vector3d line = c_point.cross(m_point);
-    double c = (-middle(0) * -line(1)) + (-middle(1) * line(0));
-    Vector3d normal(-line(1), line(0), c);
-    normal /= normal(2);
-
-    double DX = normal(1);
-    double DY = -normal(0);
+    StatsTimer timer(Stats::SG_GEOMETRY_TIME);
 
-    double norm = sqrt(pow(DX, 2) + pow(DY, 2));
-    double dx = (DX / norm) * step;
-    double dy = (DY / norm) * step;
-    VectorXd p = middle;
-    p(2) = 0;
-    bool curr, prev;
-    prev = false;
-
-    //Check direction
-    p(0) += (5*dx);
-    p(1) += (5*dy);
-    VectorXd a = Vector2d(middle(0)- current(0), middle(1) - current(1));
-    VectorXd b = Vector2d(p(0) - current(0), p(1) - current(1));
-    bool dir = clockwise(a, b);
-
-    if(dir != cw)
-    {
-        dx = -dx;
-        dy = -dy;
-    }
-
-    p = middle;
+    Vector2d direction = exitDirection(current, middle, cw);
 
     //Middle point outside obstacle
-    if(map.isFree(middle))
+    if(startRay(middle.head<2>(), direction, numeric_limits<double>::infinity()))
     {
-        p(0) += dx;
-        p(1) += dy;
+        GridGeometry grid;
+        double cell = map.getGrid(grid) ? grid.resolution : step;
+
+        VectorXd p = withPosition(middle, middle.head<2>() + cell*direction);
         if(map.isFree(p))
         {
             return p;
@@ -139,75 +152,39 @@ VectorXd SGMap::exitPoint(const VectorXd& current, const VectorXd& middle, bool
         return map.getOutsidePoint();
     }
 
-    while(map.insideBound(p))
-    {
-        curr = map.isFree(p);
-        if(curr != prev)
-        {
-            return p;
-        }
-        prev = curr;
+    bool free;
+    Vector2d before, entry;
 
-        p(0) += dx;
-        p(1) += dy;
-    }
+    if(nextChange(free, before, entry))
+        return withPosition(middle, entry);
 
-    return p;
+    return withPosition(middle, getRayEnd());
 }
 
 vector<VectorXd> SGMap::infiniteExitPoint(const VectorXd& current, const VectorXd& middle, bool cw)
 {
-    Vector3d c_point(current(0), current(1), 1);
-    Vector3d m_point(middle(0), middle(1), 1);
-    Vector3d line = c_point.cross(m_point);
-    double c = (-middle(0) * -line(1)) + (-middle(1) * line(0));
-    Vector3d normal(-line(1), line(0), c);
-    normal /= normal(2);
-
-    double DX = normal(1);
-    double DY = -normal(0);
-
-    double norm = sqrt(pow(DX, 2) + pow(DY, 2));
-    double dx = (DX / norm) * step;
-    double dy = (DY / norm) * step;
-    VectorXd p = middle;
-    p(2) = 0;
-    bool curr, prev;
-    prev = false;
+    StatsTimer timer(Stats::SG_GEOMETRY_TIME);
 
     vector<VectorXd> samples;
 
-    //Check direction
-    p(0) += (5*dx);
-    p(1) += (5*dy);
-    VectorXd a = Vector2d(middle(0)- current(0), middle(1) - current(1));
-    VectorXd b = Vector2d(p(0) - current(0), p(1) - current(1));
-    bool dir = clockwise(a, b);
+    bool free;
+    Vector2d before, entry;
 
-    if(dir != cw)
+    if(startRay(middle.head<2>(), exitDirection(current, middle, cw), numeric_limits<double>::infinity()))
     {
-        dx = -dx;
-        dy = -dy;
+        samples.push_back(middle);
+        if(samples.size() == k_los)
+            return samples;
     }
 
-    p = middle;
-
-    while(map.insideBound(p))
+    while(nextChange(free, before, entry))
     {
-        curr = map.isFree(p);
-        if(curr != prev)
+        if(free)
         {
-            if(curr)
-            {
-                samples.push_back(p);
-                if(samples.size() == k_los)
-                    return samples;
-            }
+            samples.push_back(withPosition(middle, entry));
+            if(samples.size() == k_los)
+                return samples;
         }
-        prev = curr;
-
-        p(0) += dx;
-        p(1) += dy;
     }
 
     return samples;
@@ -215,31 +192,20 @@ vector<VectorXd> SGMap::infiniteExitPoint(const VectorXd& current, const VectorX
 
 void SGMap::forcedUpdate(const VectorXd& a, const VectorXd& b, vector<VectorXd>& actions)
 {
+    StatsTimer timer(Stats::SG_GEOMETRY_TIME);
+
     actions.clear();
-    double DX = b(0) - a(0);
-    double DY = b(1) - a(1);
-    double norm = sqrt(pow(DX, 2) + pow(DY, 2));
+    Vector2d direction = b.head<2>() - a.head<2>();
 
-    double dx = (DX / norm) * step;
-    double dy = (DY / norm) * step;
-    VectorXd p = b;
-    bool curr, prev;
-    curr = prev = map.isFree(p);
+    bool free;
+    Vector2d before, entry;
+    startRay(b.head<2>(), direction.normalized(), numeric_limits<double>::infinity());
 
-    while(map.insideBound(p))
+    while(nextChange(free, before, entry))
     {
-        curr = map.isFree(p);
-        p(0) += dx;
-        p(1) += dy;
-
-        if(curr != prev)
-        {
-            actions.push_back(p);
-            if(actions.size() == 2)
-                return;
-        }
-
-        prev = curr;
+        actions.push_back(withPosition(b, entry));
+        if(actions.size() == 2)
+            return;
     }
 
     return;
@@ -247,24 +213,24 @@ void SGMap::forcedUpdate(const VectorXd& a, const VectorXd& b, vector<VectorXd>&
 
 bool SGMap::followObstacle(const VectorXd& current, const VectorXd& a, vector<VectorXd>& actions)
 {
+    StatsTimer timer(Stats::SG_GEOMETRY_TIME);
+
     actions.clear();
-    double DX = a(0) - current(0);
-    double DY = a(1) - current(1);
-    double norm = sqrt(pow(DX, 2) + pow(DY, 2));
-    double dx = (DX / norm) * step;
-    double dy = (DY / norm) * step;
-    VectorXd p = a;
-    vector<VectorXd> dummy;
+    Vector2d direction = a.head<2>() - current.head<2>();
+    caster.start(a.head<2>(), direction.normalized(), numeric_limits<double>::infinity(), step);
 
-    while(map.insideBound(p) && map.isFree(p))
+    //One corner test in each free cell crossed
+    while(caster.isInside() && caster.isFree())
     {
+        VectorXd p = withPosition(a, caster.getEntryPoint());
         if(isCorner(p))
         {
             actions.push_back(p);
             return true;
         }
-        p(0) += dx;
-        p(1) += dy;
+
+        if(!caster.next())
+            break;
     }
 
     forcedUpdate(current, a, actions);
@@ -273,32 +239,49 @@ bool SGMap::followObstacle(const VectorXd& current, const VectorXd& a, vector<Ve
 
 bool SGMap::isCorner(const VectorXd& current)
 {
-    double delta = 2*M_PI / discretization;
-    double angle = current(2);
+    Stats::count(Stats::SG_CORNER);
+    StatsTimer timer(Stats::SG_GEOMETRY_TIME);
+
+    //Vertices of the obstacle polygons
+    if(contoursReady)
+        return map.isFree(current) && contours.isCorner(current.head<2>(), ray);
+
+    //Lookup in the corner layer precomputed with the map
+    if(map.hasCorners())
+        return map.isCorner(current, ray);
+
+    double c = cos(current(2));
+    double s = sin(current(2));
+    Matrix2d R;
+    R << c, -s,
+         s,  c;
+
+    cornerSamples.noalias() = R*circle;
+    cornerSamples.colwise() += current.head<2>();
+    map.isFreeBatch(cornerSamples, cornerFree.data());
+
+    auto sample = [&](int i) -> VectorXd
+    {
+        VectorXd p = current;
+        p.head<2>() = cornerSamples.col(i);
+        return p;
+    };
 
-    VectorXd p = current;
-    p(0) = current(0) + ray*cos(angle);
-    p(1) = current(1) + ray*sin(angle);
-    VectorXd old = p;
     bool curr, prev;
-    curr = prev = map.isFree(p);
+    curr = prev = cornerFree(0);
 
     vector<VectorXd> points;
-    for(uint i = 0; i < discretization; i++)
+    for(int i = 1; i <= discretization; i++)
     {
-        old = p;
-        angle += delta;
-        p(0) = current(0) + ray*cos(angle);
-        p(1) = current(1) + ray*sin(angle);
-        curr = map.isFree(p);
+        curr = cornerFree(i);
 
         if(curr != prev)
         {
             //Get collisions as points inside the obstacle
             if(curr)
-                points.push_back(old);
+                points.push_back(sample(i - 1));
             else
-                points.push_back(p);
+                points.push_back(sample(i));
         }
 
         if(points.size() == 2)
@@ -342,8 +325,139 @@ bool SGMap::isTrueCornerWOW(const VectorXd& current)
     return map.isFree(Vector3d(x, y, 0));
 }
 
+VectorXd SGMap::withPosition(const VectorXd& state, const Vector2d& p)
+{
+    VectorXd result = state;
+    result.head<2>() = p;
+    return result;
+}
+
+Vector2d SGMap::exitDirection(const VectorXd& current, const VectorXd& middle, bool cw)
+{
+    Vector3d c_point(current(0), current(1), 1);
+    Vector3d m_point(middle(0), middle(1), 1);
+    Vector3d line = c_point.cross(m_point);
+    double c = (-middle(0) * -line(1)) + (-middle(1) * line(0));
+    Vector3d normal(-line(1), line(0), c);
+    normal /= normal(2);
+
+    Vector2d direction(normal(1), -normal(0));
+    direction.normalize();
+
+    //Check direction
+    VectorXd a = Vector2d(middle(0) - current(0), middle(1) - current(1));
+    VectorXd b = Vector2d(middle(0) + 5*step*direction(0) - current(0),
+                          middle(1) + 5*step*direction(1) - current(1));
+    bool dir = clockwise(a, b);
+
+    if(dir != cw)
+        direction = -direction;
+
+    return direction;
+}
+
+bool SGMap::startRay(const Vector2d& origin, const Vector2d& direction, double tMax)
+{
+    rayBounded = !std::isinf(tMax);
+    rayDone = false;
+
+    if(contoursReady)
+    {
+        //The segment of the ray inside the map
+        double t = rayBounded ? tMax : contours.leave(origin, direction);
+        rayOrigin = origin;
+        raySegment = t*direction;
+
+        GridGeometry grid;
+        map.getGrid(grid);
+        double length = raySegment.norm();
+        rayNudge = (length > 0) ? 1e-3 * grid.resolution / length : 0;
+
+        contours.intersect(rayOrigin, rayOrigin + raySegment, crossings);
+        crossingIndex = 0;
+
+        VectorXd p = origin;
+        rayFree = map.isFree(p);
+        return rayFree;
+    }
+
+    caster.start(origin, direction, tMax, step);
+
+    //Unbounded rays are traced inside the map only
+    rayDone = !rayBounded && !caster.isInside();
+    rayFree = caster.isFree();
+    return rayFree;
+}
+
+bool SGMap::nextChange(bool& free, Vector2d& before, Vector2d& entry)
+{
+    if(contoursReady)
+    {
+        while(crossingIndex < crossings.size())
+        {
+            const ObstacleContours::Crossing& crossing = crossings[crossingIndex++];
+
+            //The border of the map ends the unbounded rays
+            if(!rayBounded && crossing.t >= 1 - rayNudge)
+                return false;
+
+            bool curr = !crossing.entering;
+            if(curr == rayFree)
+                continue;
+
+            rayFree = free = curr;
+            before = rayOrigin + std::max(crossing.t - rayNudge, 0.0)*raySegment;
+            entry = rayOrigin + (crossing.t + rayNudge)*raySegment;
+            return true;
+        }
+
+        return false;
+    }
+
+    if(rayDone)
+        return false;
+
+    if(rayFree)
+        caster.skipFree();
+
+    while(caster.next())
+    {
+        if(!rayBounded && !caster.isInside())
+        {
+            rayDone = true;
+            return false;
+        }
+
+        bool curr = caster.isFree();
+
+        if(curr != rayFree)
+        {
+            rayFree = free = curr;
+            before = caster.getBeforePoint();
+            entry = caster.getEntryPoint();
+            return true;
+        }
+
+        if(curr)
+            caster.skipFree();
+    }
+
+    rayDone = true;
+    return false;
+}
+
+Vector2d SGMap::getRayEnd()
+{
+    if(contoursReady)
+        return rayOrigin + (rayBounded ? 1 : 1 + rayNudge)*raySegment;
+
+    return caster.getEntryPoint();
+}
+
 VectorXd SGMap::computeMiddle(const VectorXd& a, const VectorXd& b)
 {
+    StatsTimer timer(Stats::SG_GEOMETRY_TIME);
+
     double dx = fabs(b(0) - a(0));
     double dy = fabs(b(1) - a(1));
     VectorXd middle = a;
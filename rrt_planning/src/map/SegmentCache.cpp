@@ -0,0 +1,134 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/SegmentCache.h"
+#include "rrt_planning/utils/Stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+SegmentCache::SegmentCache()
+{
+    mask = 0;
+    quantum = 1;
+    generation = 1;
+}
+
+void SegmentCache::initialize(int size, double quantum)
+{
+    this->quantum = quantum;
+
+    std::size_t slotsCount = 0;
+    if(size > 0)
+    {
+        slotsCount = 1;
+        while(slotsCount < static_cast<std::size_t>(size))
+            slotsCount <<= 1;
+    }
+
+    Entry empty = Entry();
+    slots.assign(slotsCount, empty);
+    mask = slotsCount - 1;
+    generation = 1;
+}
+
+void SegmentCache::clear()
+{
+    //The entries of the old generations become unreachable
+    if(++generation == 0)
+    {
+        for(Entry& entry : slots)
+            entry.generation = 0;
+
+        generation = 1;
+    }
+}
+
+const SegmentCache::Entry* SegmentCache::find(const Vector2d& a, const Vector2d& b)
+{
+    if(slots.empty())
+        return nullptr;
+
+    int64_t key[4];
+    const Entry& entry = slots[computeKey(a, b, key)];
+
+    if(entry.generation == generation && std::equal(key, key + 4, entry.key))
+    {
+        Stats::count(Stats::SG_CACHE_HIT);
+        return &entry;
+    }
+
+    Stats::count(Stats::SG_CACHE_MISS);
+    return nullptr;
+}
+
+void SegmentCache::insert(const Vector2d& a, const Vector2d& b, bool result,
+                          const std::vector<VectorXd>& points, const VectorXd& end)
+{
+    //Checks are expected to return at most two points
+    if(slots.empty() || points.size() > 2)
+        return;
+
+    int64_t key[4];
+    Entry& entry = slots[computeKey(a, b, key)];
+
+    std::copy(key, key + 4, entry.key);
+    entry.generation = generation;
+    entry.result = result;
+    entry.points = points.size();
+
+    for(int i = 0; i < entry.points; i++)
+    {
+        entry.x[i] = points[i](0);
+        entry.y[i] = points[i](1);
+        entry.fromEnd[i] = (points[i] == end);
+    }
+}
+
+std::size_t SegmentCache::computeKey(const Vector2d& a, const Vector2d& b, int64_t* key) const
+{
+    key[0] = std::llround(a(0) / quantum);
+    key[1] = std::llround(a(1) / quantum);
+    key[2] = std::llround(b(0) / quantum);
+    key[3] = std::llround(b(1) / quantum);
+
+    uint64_t hash = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        hash ^= static_cast<uint64_t>(key[i]) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+
+    //Final mix, so that the low bits depend on every coordinate
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash & mask;
+}
+
+}
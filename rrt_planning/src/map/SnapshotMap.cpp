@@ -0,0 +1,588 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/SnapshotMap.h"
+#include "rrt_planning/map/ClearanceField.h"
+#include "rrt_planning/utils/Stats.h"
+
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#ifdef RRT_PLANNING_AVX2
+#include <immintrin.h>
+#endif
+
+namespace rrt_planning
+{
+
+SnapshotMap::SnapshotMap(costmap_2d::Costmap2DROS* costmap_ros) : costmap_ros(costmap_ros)
+{
+    initialize();
+    update();
+}
+
+SnapshotMap::SnapshotMap(int sizeX, int sizeY, double resolution, double originX, double originY,
+                         const unsigned char* costs) : costmap_ros(nullptr)
+{
+    initialize();
+
+    MapVersion* version = new MapVersion();
+    version->number = ++lastNumber;
+    version->fullNumber = version->number;
+
+    version->resize(sizeX, sizeY);
+    version->resolution = resolution;
+    version->invResolution = 1.0 / resolution;
+    version->originX = originX;
+    version->originY = originY;
+
+    for(int y = 0; y < sizeY; y++)
+        version->costs.setRow(0, y, costs + static_cast<std::size_t>(y) * sizeX, sizeX);
+
+    version->computeBits();
+    version->pyramid.update(*version);
+
+    publish(version);
+    pin();
+}
+
+void SnapshotMap::initialize()
+{
+    //Empty until the first version is pinned
+    pinned = std::make_shared<MapVersion>();
+    current = pinned.get();
+
+    lastNumber = 0;
+    clearanceField = nullptr;
+    cornerRadius = 0;
+    cornerThreshold = 0;
+    incremental = false;
+
+    changedKnown = false;
+    changedMinX = changedMinY = 0;
+    changedMaxX = changedMaxY = 0;
+
+#ifdef RRT_PLANNING_AVX2
+    useAVX2 = __builtin_cpu_supports("avx2");
+#else
+    useAVX2 = false;
+#endif
+}
+
+bool SnapshotMap::isFree(const Eigen::VectorXd& p)
+{
+    Stats::count(Stats::MAP_IS_FREE);
+    int mx, my;
+    return worldToMap(p(0), p(1), mx, my) && isFreeCell(mx, my);
+}
+
+bool SnapshotMap::isVoronoiFree(const Eigen::VectorXd& p)
+{
+    int mx, my;
+    return worldToMap(p(0), p(1), mx, my) && isVoronoiFreeCell(mx, my);
+}
+
+unsigned char SnapshotMap::getCost(const Eigen::VectorXd& p)
+{
+    int mx, my;
+
+    if(worldToMap(p(0), p(1), mx, my))
+        return getCostCell(mx, my);
+    else
+        return costmap_2d::NO_INFORMATION;
+}
+
+bool SnapshotMap::insideBound(const Eigen::VectorXd& p)
+{
+    int mx, my;
+    return worldToMap(p(0), p(1), mx, my);
+}
+
+Eigen::VectorXd SnapshotMap::getOutsidePoint()
+{
+    Eigen::Vector3d p(bounds.maxX + 1.0, bounds.maxY + 1.0, 0);
+    return p;
+}
+
+void SnapshotMap::update()
+{
+    StatsTimer timer(Stats::MAP_UPDATE_TIME);
+
+    //Maps loaded without a costmap are published once
+    if(costmap_ros)
+    {
+        std::shared_ptr<const MapVersion> latest = std::atomic_load(&published);
+
+        if(!incremental || !latest || isOutdated(*latest))
+            publishFull();
+    }
+
+    pin();
+}
+
+void SnapshotMap::pin()
+{
+    std::shared_ptr<const MapVersion> latest = std::atomic_load(&published);
+
+    if(!latest)
+        return;
+
+    changedKnown = latest->getChangedSince(current->getNumber(), changedMinX, changedMinY,
+                                           changedMaxX, changedMaxY);
+
+    //The previous version is released here, unless another reader still holds it
+    pinned = latest;
+    current = pinned.get();
+
+    bounds.minX = current->getOriginX();
+    bounds.minY = current->getOriginY();
+    bounds.maxX = current->getOriginX() + current->getSizeX() * current->getResolution();
+    bounds.maxY = current->getOriginY() + current->getSizeY() * current->getResolution();
+    bounds.minZ = 0;
+    bounds.maxZ = 0;
+}
+
+bool SnapshotMap::isOutdated(const MapVersion& version)
+{
+    costmap_2d::Costmap2D* costmap = costmap_ros->getCostmap();
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap->getMutex(), boost::try_to_lock);
+
+    //Never wait for the costmap, a busy costmap is checked by the next query
+    if(!lock.owns_lock())
+        return false;
+
+    return !isSameGrid(*costmap, version);
+}
+
+bool SnapshotMap::isSameGrid(const costmap_2d::Costmap2D& costmap, const MapVersion& version)
+{
+    return static_cast<int>(costmap.getSizeInCellsX()) == version.getSizeX() &&
+           static_cast<int>(costmap.getSizeInCellsY()) == version.getSizeY() &&
+           costmap.getResolution() == version.getResolution() &&
+           costmap.getOriginX() == version.getOriginX() && costmap.getOriginY() == version.getOriginY();
+}
+
+void SnapshotMap::publishFull()
+{
+    boost::mutex::scoped_lock publishLock(publishMutex);
+    buildFull();
+}
+
+void SnapshotMap::buildFull()
+{
+    costmap_2d::Costmap2D* costmap = costmap_ros->getCostmap();
+    MapVersion* version = new MapVersion();
+
+    {
+        boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap->getMutex());
+
+        version->resize(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
+        version->resolution = costmap->getResolution();
+        version->invResolution = 1.0 / version->resolution;
+        version->originX = costmap->getOriginX();
+        version->originY = costmap->getOriginY();
+
+        const unsigned char* charMap = costmap->getCharMap();
+        for(int y = 0; y < version->sizeY; y++)
+            version->costs.setRow(0, y, charMap + static_cast<std::size_t>(y) * version->sizeX, version->sizeX);
+    }
+
+    version->number = ++lastNumber;
+    version->fullNumber = version->number;
+
+    version->computeBits();
+    version->pyramid.update(*version);
+
+    if(clearanceField)
+    {
+        clearanceField->update(*version);
+        clearanceField->fill(version->clearance);
+    }
+
+    if(cornerRadius > 0)
+        version->corners.update(*version, cornerRadius * version->invResolution, cornerThreshold);
+
+    publish(version);
+}
+
+void SnapshotMap::publishWindow(int minX, int minY, int maxX, int maxY)
+{
+    boost::mutex::scoped_lock publishLock(publishMutex);
+
+    std::shared_ptr<const MapVersion> previous = std::atomic_load(&published);
+    if(!previous)
+    {
+        buildFull();
+        return;
+    }
+
+    MapVersion* version;
+
+    {
+        costmap_2d::Costmap2D* costmap = costmap_ros->getCostmap();
+        boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap->getMutex());
+
+        //The window is in the cells of the costmap, checked under the lock of the copy
+        if(!isSameGrid(*costmap, *previous))
+        {
+            lock.unlock();
+            buildFull();
+            return;
+        }
+
+        minX = std::max(minX, 0);
+        minY = std::max(minY, 0);
+        maxX = std::min(maxX, previous->getSizeX());
+        maxY = std::min(maxY, previous->getSizeY());
+
+        if(minX >= maxX || minY >= maxY)
+            return;
+
+        //Copy on write, the new version shares the tiles outside the window and
+        //readers keep using the previous version meanwhile
+        version = new MapVersion(*previous);
+
+        const unsigned char* charMap = costmap->getCharMap();
+        for(int y = minY; y < maxY; y++)
+        {
+            std::size_t row = static_cast<std::size_t>(y) * version->sizeX;
+            version->costs.setRow(minX, y, charMap + row + minX, maxX - minX);
+        }
+    }
+
+    version->number = ++lastNumber;
+    version->addHistory(minX, minY, maxX, maxY);
+
+    version->computeBits(minX, minY, maxX, maxY);
+    version->pyramid.update(*version, minX, minY, maxX, maxY);
+
+    if(clearanceField)
+    {
+        clearanceField->update(*version, minX, minY, maxX, maxY);
+        clearanceField->fill(version->clearance, minX, minY, maxX, maxY);
+    }
+
+    version->corners.update(*version, minX, minY, maxX, maxY);
+
+    publish(version);
+}
+
+void SnapshotMap::publish(MapVersion* version)
+{
+    std::shared_ptr<const MapVersion> next(version);
+    std::atomic_store(&published, next);
+}
+
+bool SnapshotMap::reportsChanges()
+{
+    //A full copy on every update forgets what changed
+    return incremental || !costmap_ros;
+}
+
+bool SnapshotMap::getChangedBounds(Bounds& changed)
+{
+    if(!changedKnown)
+        return false;
+
+    changed.minX = current->getOriginX() + changedMinX * current->getResolution();
+    changed.minY = current->getOriginY() + changedMinY * current->getResolution();
+    changed.maxX = current->getOriginX() + changedMaxX * current->getResolution();
+    changed.maxY = current->getOriginY() + changedMaxY * current->getResolution();
+    changed.minZ = 0;
+    changed.maxZ = 0;
+
+    return true;
+}
+
+void SnapshotMap::enableIncremental(ros::NodeHandle& nh)
+{
+    std::string topic;
+    nh.param("costmap_updates", topic, std::string("/move_base/global_costmap/costmap_updates"));
+
+    incremental = true;
+    updateSubscriber = nh.subscribe(topic, 10, &SnapshotMap::costmapUpdateCallback, this);
+
+    //Changes made before the subscription are not announced
+    publishFull();
+    pin();
+}
+
+void SnapshotMap::costmapUpdateCallback(const map_msgs::OccupancyGridUpdate::ConstPtr& msg)
+{
+    publishWindow(msg->x, msg->y, msg->x + msg->width, msg->y + msg->height);
+}
+
+void SnapshotMap::enableClearance()
+{
+    {
+        boost::mutex::scoped_lock publishLock(publishMutex);
+
+        if(clearanceField)
+            return;
+
+        clearanceField = new ClearanceField();
+
+        std::shared_ptr<const MapVersion> previous = std::atomic_load(&published);
+        if(!previous)
+            return;
+
+        //Same cells as the previous version, with the clearance layer
+        MapVersion* version = new MapVersion(*previous);
+        version->number = ++lastNumber;
+        version->addHistory(0, 0, 0, 0);
+
+        clearanceField->update(*version);
+        clearanceField->fill(version->clearance);
+
+        publish(version);
+    }
+
+    pin();
+}
+
+void SnapshotMap::enableCorners(double radius, double threshold)
+{
+    {
+        boost::mutex::scoped_lock publishLock(publishMutex);
+
+        if(cornerRadius > 0)
+            return;
+
+        cornerRadius = radius;
+        cornerThreshold = threshold;
+
+        std::shared_ptr<const MapVersion> previous = std::atomic_load(&published);
+        if(!previous)
+            return;
+
+        //Same cells as the previous version, with the corner layer
+        MapVersion* version = new MapVersion(*previous);
+        version->number = ++lastNumber;
+        version->addHistory(0, 0, 0, 0);
+
+        version->corners.update(*version, cornerRadius * version->invResolution, cornerThreshold);
+
+        publish(version);
+    }
+
+    pin();
+}
+
+void SnapshotMap::isFreeBatch(const Eigen::Matrix2Xd& points, bool* out)
+{
+    Stats::count(Stats::MAP_BATCH_POINTS, points.cols());
+    isFreeKernel(points.data(), points.cols(), out);
+}
+
+bool SnapshotMap::getGrid(GridGeometry& grid)
+{
+    grid.resolution = current->getResolution();
+    grid.originX = current->getOriginX();
+    grid.originY = current->getOriginY();
+    grid.sizeX = current->getSizeX();
+    grid.sizeY = current->getSizeY();
+
+    return true;
+}
+
+bool SnapshotMap::isFreeGridCell(int mx, int my)
+{
+    return mx >= 0 && my >= 0 && mx < current->getSizeX() && my < current->getSizeY() &&
+           current->isFreeCell(mx, my);
+}
+
+double SnapshotMap::getClearance(const Eigen::VectorXd& p)
+{
+    int mx, my;
+
+    if(current->hasClearance() && worldToMap(p(0), p(1), mx, my))
+        return current->getClearanceCell(mx, my);
+    else
+        return 0;
+}
+
+int SnapshotMap::freeSteps(const Eigen::Vector2d& p, const Eigen::Vector2d& delta)
+{
+    int mx, my;
+
+    if(worldToMap(p(0), p(1), mx, my) && isFreeCell(mx, my))
+        return freeStepsCell(mx, my, p, delta);
+    else
+        return 0;
+}
+
+bool SnapshotMap::isCorridorFree(const Eigen::VectorXd& a, const Eigen::VectorXd& b, double radius)
+{
+    Stats::count(Stats::MAP_CORRIDOR);
+
+    Eigen::Vector2d origin(current->getOriginX(), current->getOriginY());
+    double invResolution = current->getInvResolution();
+    Eigen::Vector2d ca = (a.head<2>() - origin) * invResolution;
+    Eigen::Vector2d cb = (b.head<2>() - origin) * invResolution;
+
+    return current->getPyramid().isCorridorFree(ca, cb, radius * invResolution);
+}
+
+double SnapshotMap::getFreeFraction(const Eigen::VectorXd& a, const Eigen::VectorXd& b, double radius)
+{
+    Stats::count(Stats::MAP_CORRIDOR);
+
+    Eigen::Vector2d origin(current->getOriginX(), current->getOriginY());
+    double invResolution = current->getInvResolution();
+    Eigen::Vector2d ca = (a.head<2>() - origin) * invResolution;
+    Eigen::Vector2d cb = (b.head<2>() - origin) * invResolution;
+
+    return current->getPyramid().freeFraction(ca, cb, radius * invResolution);
+}
+
+bool SnapshotMap::hasCorners()
+{
+    return current->hasCorners();
+}
+
+bool SnapshotMap::isCorner(const Eigen::VectorXd& p, double radius)
+{
+    double invResolution = current->getInvResolution();
+    double x = (p(0) - current->getOriginX()) * invResolution;
+    double y = (p(1) - current->getOriginY()) * invResolution;
+
+    return current->getCorners().isCorner(*current, x, y, radius * invResolution);
+}
+
+int SnapshotMap::freeStepsCell(int mx, int my, const Eigen::Vector2d& p, const Eigen::Vector2d& delta) const
+{
+    double steps = 0;
+
+    //Every sample closer than the clearance is free
+    if(current->hasClearance())
+        steps = current->getClearanceCell(mx, my) / delta.norm();
+
+    //As is every sample before the ray leaves the largest free block around the cell
+    int level = current->getPyramid().freeLevel(mx, my);
+    if(level >= 0)
+    {
+        int size = 1 << level;
+        double t = std::numeric_limits<double>::infinity();
+
+        for(int i = 0; i < 2; i++)
+        {
+            double c = ((i == 0 ? p(0) - current->getOriginX() : p(1) - current->getOriginY())) *
+                       current->getInvResolution();
+            double d = delta(i) * current->getInvResolution();
+            int block = ((i == 0) ? mx : my) >> level;
+
+            if(d > 0)
+                t = std::min(t, ((block + 1)*size - c) / d);
+            else if(d < 0)
+                t = std::min(t, (block*size - c) / d);
+        }
+
+        //Samples on the far border belong to the next block
+        steps = std::max(steps, std::ceil(t - 1e-6) - 1);
+    }
+
+    return (steps >= 1) ? static_cast<int>(std::min(steps, 1e6)) : 0;
+}
+
+void SnapshotMap::isFreeKernel(const double* points, int n, bool* out) const
+{
+    int i = 0;
+
+#ifdef RRT_PLANNING_AVX2
+    if(useAVX2)
+    {
+        i = n - n % 4;
+        isFreeKernelAVX2(points, i, out);
+    }
+#endif
+
+    for(; i < n; i++)
+    {
+        out[i] = isFree(points[2*i], points[2*i + 1]);
+    }
+}
+
+#ifdef RRT_PLANNING_AVX2
+__attribute__((target("avx2")))
+void SnapshotMap::isFreeKernelAVX2(const double* points, int n, bool* out) const
+{
+    const __m256d origin_x = _mm256_set1_pd(current->getOriginX());
+    const __m256d origin_y = _mm256_set1_pd(current->getOriginY());
+    const __m256d res = _mm256_set1_pd(current->getResolution());
+    const __m128i size_x = _mm_set1_epi32(current->getSizeX());
+    const __m128i size_y = _mm_set1_epi32(current->getSizeY());
+    const __m128i tiles_x = _mm_set1_epi32(current->freeBits.getTilesX());
+    const __m128i row_mask = _mm_set1_epi32(MapVersion::BitLayer::TILE_Y - 1);
+    const __m256i bit_mask = _mm256_set1_epi64x(63);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const long long* tiles = reinterpret_cast<const long long*>(current->freeBits.getTiles());
+
+    for(int i = 0; i < n; i += 4)
+    {
+        //Deinterleave four (x, y) pairs
+        __m256d a = _mm256_loadu_pd(points + 2*i);
+        __m256d b = _mm256_loadu_pd(points + 2*i + 4);
+        __m256d x = _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), 0xD8);
+        __m256d y = _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), 0xD8);
+
+        //World to cell conversion, cells below the origin become negative
+        __m128i mx = _mm256_cvttpd_epi32(_mm256_floor_pd(_mm256_div_pd(_mm256_sub_pd(x, origin_x), res)));
+        __m128i my = _mm256_cvttpd_epi32(_mm256_floor_pd(_mm256_div_pd(_mm256_sub_pd(y, origin_y), res)));
+
+        __m128i valid = _mm_and_si128(_mm_cmpgt_epi32(size_x, mx), _mm_cmpgt_epi32(size_y, my));
+        valid = _mm_andnot_si128(_mm_or_si128(_mm_cmplt_epi32(mx, _mm_setzero_si128()),
+                                              _mm_cmplt_epi32(my, _mm_setzero_si128())), valid);
+
+        //Gather the tiles of the valid lanes, then the words of their rows
+        __m128i tile = _mm_add_epi32(_mm_mullo_epi32(_mm_srli_epi32(my, 6), tiles_x), _mm_srli_epi32(mx, 6));
+        __m256i lanes = _mm256_cvtepi32_epi64(valid);
+        __m256i base = _mm256_mask_i32gather_epi64(_mm256_setzero_si256(), tiles, tile, lanes, 8);
+        __m256i address = _mm256_add_epi64(base, _mm256_slli_epi64(
+                                               _mm256_cvtepu32_epi64(_mm_and_si128(my, row_mask)), 3));
+        __m256i word = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), nullptr, address, lanes, 1);
+        __m256i bit = _mm256_and_si256(_mm256_srlv_epi64(word, _mm256_and_si256(
+                                           _mm256_cvtepu32_epi64(mx), bit_mask)), one);
+
+        alignas(32) long long result[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(result), bit);
+
+        out[i] = result[0];
+        out[i + 1] = result[1];
+        out[i + 2] = result[2];
+        out[i + 3] = result[3];
+    }
+}
+#endif
+
+SnapshotMap::~SnapshotMap()
+{
+    updateSubscriber.shutdown();
+
+    boost::mutex::scoped_lock publishLock(publishMutex);
+    if(clearanceField)
+        delete clearanceField;
+}
+
+}
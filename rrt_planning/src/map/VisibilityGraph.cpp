@@ -0,0 +1,266 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/map/VisibilityGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+static inline double cross(const Vector2d& a, const Vector2d& b)
+{
+    return a(0) * b(1) - a(1) * b(0);
+}
+
+VisibilityGraph::VisibilityGraph(Map& map) : map(map), ready(false)
+{
+    goal.setZero();
+}
+
+void VisibilityGraph::update(double tolerance)
+{
+    Bounds changed;
+    bool known = map.getChangedBounds(changed);
+
+    if(!ready || !known || (changed.minX < changed.maxX && changed.minY < changed.maxY))
+        build(tolerance);
+}
+
+void VisibilityGraph::setGoal(const Vector2d& goal)
+{
+    this->goal = goal;
+    labels.assign(nodes.size(), std::numeric_limits<double>::infinity());
+    labeled.clear();
+    via.clear();
+
+    if(!ready)
+        return;
+
+    typedef std::pair<double, int> Entry;
+    std::vector<Entry> heap;
+
+    //The goal is the source, connected to the corners it sees
+    for(int i = 0; i < static_cast<int>(nodes.size()); i++)
+    {
+        if(isTangent(i, goal) && contours.isClear(nodes[i], goal))
+        {
+            labels[i] = (nodes[i] - goal).norm();
+            heap.push_back(Entry(labels[i], i));
+        }
+    }
+
+    std::make_heap(heap.begin(), heap.end(), std::greater<Entry>());
+
+    while(!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+
+        int i = top.second;
+        if(top.first > labels[i])
+            continue;
+
+        labeled.push_back(i);
+
+        for(int e = edgeStart[i]; e < edgeStart[i + 1]; e++)
+        {
+            int j = edgeTargets[e];
+            double label = labels[i] + edgeLengths[e];
+
+            if(label < labels[j])
+            {
+                labels[j] = label;
+                heap.push_back(Entry(label, j));
+                std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            }
+        }
+    }
+}
+
+double VisibilityGraph::distance(const Vector2d& p)
+{
+    if(!ready)
+        return std::numeric_limits<double>::infinity();
+
+    int x = std::floor((p(0) - grid.originX) / grid.resolution);
+    int y = std::floor((p(1) - grid.originY) / grid.resolution);
+    bool inside = x >= 0 && y >= 0 && x < grid.sizeX && y < grid.sizeY;
+
+    int hint = NONE;
+    std::size_t cell = inside ? static_cast<std::size_t>(y) * grid.sizeX + x : 0;
+
+    //Corner of the cell, if p sees it as well
+    if(inside)
+    {
+        auto it = via.find(cell);
+        if(it != via.end())
+        {
+            hint = it->second;
+            if(hint != NONE && !contours.isClear(p, (hint == GOAL) ? goal : nodes[hint]))
+                hint = NONE;
+        }
+    }
+
+    int i = search(p, hint);
+    if(inside)
+        via[cell] = i;
+
+    if(i == NONE)
+        return std::numeric_limits<double>::infinity();
+
+    if(i == GOAL)
+        return (p - goal).norm();
+
+    return (p - nodes[i]).norm() + labels[i];
+}
+
+void VisibilityGraph::build(double tolerance)
+{
+    nodes.clear();
+    corners.clear();
+    edgeStart.clear();
+    edgeTargets.clear();
+    edgeLengths.clear();
+    labels.clear();
+    labeled.clear();
+
+    via.clear();
+
+    ready = map.getGrid(grid) && contours.build(map, tolerance);
+
+    if(!ready)
+        return;
+
+    //Corners pushed along their bisector, so that rays to them do not graze the obstacle
+    double offset = 1e-2 * grid.resolution;
+
+    for(int i = 0; i < contours.getVertices(); i++)
+    {
+        if(!contours.isConvex(i))
+            continue;
+
+        const Vector2d& v = contours.getVertex(i);
+        Vector2d in = (v - contours.getVertex(contours.getPrevious(i))).normalized();
+        Vector2d out = (contours.getVertex(contours.getNext(i)) - v).normalized();
+
+        //The free side is on the right of the edges
+        Vector2d normal(in(1) + out(1), -in(0) - out(0));
+        nodes.push_back(v + offset * normal.normalized());
+        corners.push_back(i);
+    }
+
+    edgeStart.push_back(0);
+
+    for(int i = 0; i < static_cast<int>(nodes.size()); i++)
+    {
+        for(int j = 0; j < static_cast<int>(nodes.size()); j++)
+        {
+            if(i == j || !isTangent(i, nodes[j]) || !isTangent(j, nodes[i]))
+                continue;
+
+            //Each pair is traced once, the second direction reuses the result
+            bool visible;
+            if(j < i)
+            {
+                visible = std::find(edgeTargets.begin() + edgeStart[j], edgeTargets.begin() + edgeStart[j + 1], i)
+                          != edgeTargets.begin() + edgeStart[j + 1];
+            }
+            else
+            {
+                visible = contours.isClear(nodes[i], nodes[j]);
+            }
+
+            if(visible)
+            {
+                edgeTargets.push_back(j);
+                edgeLengths.push_back((nodes[i] - nodes[j]).norm());
+            }
+        }
+
+        edgeStart.push_back(edgeTargets.size());
+    }
+
+    labels.assign(nodes.size(), std::numeric_limits<double>::infinity());
+}
+
+int VisibilityGraph::search(const Vector2d& p, int hint)
+{
+    //A visible hint is a path, only the corners with a smaller lower bound can beat it
+    double bound = std::numeric_limits<double>::infinity();
+    if(hint == GOAL)
+        bound = (p - goal).norm();
+    else if(hint != NONE)
+        bound = (p - nodes[hint]).norm() + labels[hint];
+
+    //Lower bounds through each corner, tested for visibility from the smallest
+    typedef std::pair<double, int> Entry;
+    queue.clear();
+    queue.push_back(Entry((p - goal).norm(), GOAL));
+
+    for(int i : labeled)
+        if(isTangent(i, p))
+            queue.push_back(Entry((p - nodes[i]).norm() + labels[i], i));
+
+    std::make_heap(queue.begin(), queue.end(), std::greater<Entry>());
+
+    while(!queue.empty())
+    {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Entry>());
+        Entry top = queue.back();
+        int i = top.second;
+        queue.pop_back();
+
+        if(top.first >= bound)
+            return hint;
+
+        if(i == GOAL && contours.isClear(p, goal))
+            return GOAL;
+
+        if(i != GOAL && contours.isClear(p, nodes[i]))
+            return i;
+    }
+
+    return hint;
+}
+
+bool VisibilityGraph::isTangent(int node, const Vector2d& p) const
+{
+    //Both contour neighbours of the corner on the same side of the line to p
+    int i = corners[node];
+    const Vector2d& v = contours.getVertex(i);
+    Vector2d d = p - v;
+
+    double previous = cross(d, contours.getVertex(contours.getPrevious(i)) - v);
+    double next = cross(d, contours.getVertex(contours.getNext(i)) - v);
+
+    return (previous >= 0 && next >= 0) || (previous <= 0 && next <= 0);
+}
+
+}
@@ -1,5 +1,7 @@
 #include "rrt_planning/nh/Node.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace Eigen;
 
@@ -11,43 +13,65 @@ Node::Node()
 	parent = nullptr;
 }
 
-Node::Node(const VectorXd& state, Node* parent, double cost):
+Node::Node(const Vector3d& state, Node* parent, double cost):
 				state(state), parent(parent), cost(cost) {}
 
-Node::Node(const VectorXd& state, Node* parent, double cost, vector<VectorXd> mp) :
-				state(state), parent(parent), cost(cost), mp(mp) {}
+Node::Node(const Vector3d& state, Node* parent, double cost, vector<VectorXd> mp) :
+				state(state), parent(parent), cost(cost)
+{
+	setMotionPrimitives(mp);
+}
+
+void Node::initialize(const Vector3d& state, Node* parent, double cost)
+{
+	this->state = state;
+	this->parent = parent;
+	this->cost = cost;
+
+	mp.clear();
+	subgoals.clear();
+	closed_area.clear();
+}
 
-void Node::addSubgoal(const VectorXd& subgoal)
+void Node::setMotionPrimitives(const vector<VectorXd>& mp)
+{
+	this->mp.resize(mp.size());
+	for(size_t i = 0; i < mp.size(); i++)
+		this->mp[i] = mp[i];
+}
+
+void Node::setMotionPrimitives(const vector<Vector3d>& mp)
+{
+	this->mp = mp;
+}
+
+void Node::addSubgoal(const Vector3d& subgoal)
 {
 	rrt_planning::Sub pair(subgoal(0), subgoal(1));
-	subgoals.insert(pair);
+	if(find(subgoals.begin(), subgoals.end(), pair) == subgoals.end())
+		subgoals.push_back(pair);
 }
 
 void Node::addTriangle(const Triangle& t)
 {
-	closed_area.push_back(t);
+	closed_area.insert(t);
 }
 
-bool Node::insideArea(const VectorXd& p)
+bool Node::insideArea(const Vector3d& p) const
 {
-	for(auto t : closed_area)
-	{
-		if(t.contains(p))
-			return true;
-	}
-
-	return false;
+	return closed_area.contains(p.head<2>());
 }
 
-bool Node::contains(const VectorXd& subgoal)
+bool Node::contains(const Vector3d& subgoal) const
 {
 	Sub pair(subgoal(0), subgoal(1));
-	return (subgoals.count(pair) == 1);
+	return find(subgoals.begin(), subgoals.end(), pair) != subgoals.end();
 }
 
 Node* Node::setParent(Node* p)
 {
 	parent = p;
+	return parent;
 }
 
 Node* Node::getParent()
@@ -55,17 +79,17 @@ Node* Node::getParent()
 	return parent;
 }
 
-VectorXd Node::getState()
+const Vector3d& Node::getState() const
 {
 	return state;
 }
 
-vector<VectorXd> Node::getMotionPrimitives()
+const vector<Vector3d>& Node::getMotionPrimitives() const
 {
 	return mp;
 }
 
-double Node::getCost()
+double Node::getCost() const
 {
 	return cost;
 }
@@ -0,0 +1,256 @@
+#include "rrt_planning/nh/OpenList.h"
+#include "rrt_planning/utils/Stats.h"
+
+#include <functional>
+
+using namespace std;
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+static inline bool eigenOrdering(const Vector3d& a, const Vector3d& b)
+{
+	return ((a(0) < b(0)) || (a(0) == b(0) && a(1) < b(1))
+			|| (a(0) == b(0) && a(1) == b(1) && a(2) < b(2)));
+}
+
+OpenList::OpenList()
+{
+	table.assign(64, -1);
+	mask = table.size() - 1;
+}
+
+void OpenList::insert(const Key& key, double value)
+{
+	Stats::count(Stats::OPEN_INSERT);
+
+	Node* node = key.first;
+	int slot = find(node, key.second.getState());
+
+	//Already open, keep the best value
+	if(slot >= 0)
+	{
+		int position = positions[slot];
+		if(value < heap[position].value)
+		{
+			keys[slot].second = key.second;
+			heap[position].value = value;
+			siftUp(position);
+		}
+
+		return;
+	}
+
+	if(freeSlots.empty())
+	{
+		slot = keys.size();
+		keys.push_back(key);
+		positions.push_back(0);
+	}
+	else
+	{
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+		keys[slot] = key;
+	}
+
+	index(slot);
+
+	Entry entry = {value, node->getCost(), static_cast<uint32_t>(slot)};
+	heap.push_back(entry);
+	positions[slot] = heap.size() - 1;
+	siftUp(heap.size() - 1);
+}
+
+Key OpenList::pop()
+{
+	Stats::count(Stats::OPEN_POP);
+
+	int slot = heap[0].slot;
+	Key key = keys[slot];
+
+	unindex(slot);
+	freeSlots.push_back(slot);
+
+	Entry last = heap.back();
+	heap.pop_back();
+
+	if(!heap.empty())
+	{
+		place(last, 0);
+		siftDown(0);
+	}
+
+	return key;
+}
+
+void OpenList::rebuild(const function<double(const Key&)>& value)
+{
+	for(Entry& entry : heap)
+		entry.value = value(keys[entry.slot]);
+
+	if(heap.size() < 2)
+		return;
+
+	for(int position = (heap.size() - 2) / ARITY; position >= 0; position--)
+		siftDown(position);
+}
+
+void OpenList::clear()
+{
+	heap.clear();
+	freeSlots.clear();
+
+	for(int slot = keys.size() - 1; slot >= 0; slot--)
+		freeSlots.push_back(slot);
+
+	fill(table.begin(), table.end(), -1);
+}
+
+bool OpenList::less(const Entry& a, const Entry& b) const
+{
+	if(a.value != b.value)
+		return a.value < b.value;
+
+	if(a.cost != b.cost)
+		return a.cost < b.cost;
+
+	const Key& keyA = keys[a.slot];
+	const Key& keyB = keys[b.slot];
+	const Vector3d& nodeA = keyA.first->getState();
+	const Vector3d& nodeB = keyB.first->getState();
+
+	if(nodeA != nodeB)
+		return eigenOrdering(nodeA, nodeB);
+
+	return eigenOrdering(keyA.second.getState(), keyB.second.getState());
+}
+
+void OpenList::siftUp(int position)
+{
+	Entry entry = heap[position];
+
+	while(position > 0)
+	{
+		int parent = (position - 1) / ARITY;
+		if(!less(entry, heap[parent]))
+			break;
+
+		place(heap[parent], position);
+		position = parent;
+	}
+
+	place(entry, position);
+}
+
+void OpenList::siftDown(int position)
+{
+	Entry entry = heap[position];
+	int size = heap.size();
+
+	while(true)
+	{
+		int first = ARITY * position + 1;
+		if(first >= size)
+			break;
+
+		int best = first;
+		int last = min(first + ARITY, size);
+		for(int child = first + 1; child < last; child++)
+		{
+			if(less(heap[child], heap[best]))
+				best = child;
+		}
+
+		if(!less(heap[best], entry))
+			break;
+
+		place(heap[best], position);
+		position = best;
+	}
+
+	place(entry, position);
+}
+
+void OpenList::place(const Entry& entry, int position)
+{
+	heap[position] = entry;
+	positions[entry.slot] = position;
+}
+
+int OpenList::find(Node* node, const Vector3d& state) const
+{
+	for(size_t i = hash(node, state) & mask; table[i] >= 0; i = (i + 1) & mask)
+	{
+		const Key& key = keys[table[i]];
+		if(key.first == node && key.second.getState() == state)
+			return table[i];
+	}
+
+	return -1;
+}
+
+size_t OpenList::hash(Node* node, const Vector3d& state) const
+{
+	size_t h = std::hash<Node*>()(node);
+	for(int i = 0; i < state.size(); i++)
+		h ^= std::hash<double>()(state(i)) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+
+	return h;
+}
+
+void OpenList::index(int slot)
+{
+	//Keep the table at most half full
+	if(2 * (heap.size() + 1) > table.size())
+	{
+		table.assign(2 * table.size(), -1);
+		mask = table.size() - 1;
+
+		for(const Entry& entry : heap)
+			index(entry.slot);
+	}
+
+	const Key& key = keys[slot];
+	size_t i = hash(key.first, key.second.getState()) & mask;
+	while(table[i] >= 0)
+		i = (i + 1) & mask;
+
+	table[i] = slot;
+}
+
+void OpenList::unindex(int slot)
+{
+	const Key& key = keys[slot];
+	size_t i = hash(key.first, key.second.getState()) & mask;
+	while(table[i] != slot)
+		i = (i + 1) & mask;
+
+	//Backward shift, so that no probe sequence is broken
+	size_t j = i;
+	while(true)
+	{
+		table[i] = -1;
+
+		while(true)
+		{
+			j = (j + 1) & mask;
+			if(table[j] < 0)
+				return;
+
+			const Key& moved = keys[table[j]];
+			size_t home = hash(moved.first, moved.second.getState()) & mask;
+
+			//Move it back unless its home lies cyclically in (i, j]
+			bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+			if(!stays)
+				break;
+		}
+
+		table[i] = table[j];
+		i = j;
+	}
+}
+
+}
@@ -0,0 +1,82 @@
+#include "rrt_planning/nh/TriangleIndex.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+TriangleIndex::TriangleIndex(double cellSize) : cellSize(cellSize) {}
+
+void TriangleIndex::insert(const Triangle& t)
+{
+	//A degenerate triangle contains no point
+	if(t.area == 0)
+		return;
+
+	Entry e;
+	e.t = t;
+	e.min = t.a.cwiseMin(t.b).cwiseMin(t.c);
+	e.max = t.a.cwiseMax(t.b).cwiseMax(t.c);
+
+	int i = triangles.size();
+	triangles.push_back(e);
+
+	int64_t minX = floor(e.min(0) / cellSize);
+	int64_t minY = floor(e.min(1) / cellSize);
+	int64_t maxX = floor(e.max(0) / cellSize);
+	int64_t maxY = floor(e.max(1) / cellSize);
+
+	if((maxX - minX + 1) * (maxY - minY + 1) > MAX_CELLS)
+	{
+		large.push_back(i);
+		return;
+	}
+
+	for(int64_t x = minX; x <= maxX; x++)
+		for(int64_t y = minY; y <= maxY; y++)
+			cells[key(x, y)].push_back(i);
+}
+
+bool TriangleIndex::contains(const Vector2d& q) const
+{
+	for(int i : large)
+	{
+		if(contains(triangles[i], q))
+			return true;
+	}
+
+	auto it = cells.find(key(floor(q(0) / cellSize), floor(q(1) / cellSize)));
+	if(it == cells.end())
+		return false;
+
+	for(int i : it->second)
+	{
+		if(contains(triangles[i], q))
+			return true;
+	}
+
+	return false;
+}
+
+void TriangleIndex::clear()
+{
+	triangles.clear();
+	large.clear();
+
+	//The cells keep their buffers for the next round
+	for(auto& cell : cells)
+		cell.second.clear();
+}
+
+bool TriangleIndex::contains(const Entry& e, const Vector2d& p) const
+{
+	if(p(0) < e.min(0) || p(1) < e.min(1) || p(0) > e.max(0) || p(1) > e.max(1))
+		return false;
+
+	return e.t.contains(p(0), p(1));
+}
+
+}
@@ -0,0 +1,80 @@
+#include "rrt_planning/nh/TriangleSet.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+using namespace Eigen;
+
+namespace rrt_planning
+{
+
+TriangleSet::TriangleSet()
+{
+	clear();
+}
+
+void TriangleSet::insert(const Triangle& t)
+{
+	//A degenerate triangle contains no point
+	if(t.area == 0)
+		return;
+
+	s0.push_back(t.s0);
+	sx.push_back(t.sx);
+	sy.push_back(t.sy);
+	t0.push_back(t.t0);
+	tx.push_back(t.tx);
+	ty.push_back(t.ty);
+	limit.push_back(t.limit);
+
+	minX = min(minX, min(t.a(0), min(t.b(0), t.c(0))));
+	minY = min(minY, min(t.a(1), min(t.b(1), t.c(1))));
+	maxX = max(maxX, max(t.a(0), max(t.b(0), t.c(0))));
+	maxY = max(maxY, max(t.a(1), max(t.b(1), t.c(1))));
+}
+
+bool TriangleSet::contains(const Vector2d& p) const
+{
+	const double x = p(0);
+	const double y = p(1);
+
+	if(x < minX || y < minY || x > maxX || y > maxY)
+		return false;
+
+	const int n = limit.size();
+	for(int i = 0; i < n; i += BLOCK)
+	{
+		const int end = min(n, i + BLOCK);
+
+		//No early exit inside a block, so the loop is vectorized over triangles
+		bool inside = false;
+		for(int j = i; j < end; j++)
+		{
+			double s = s0[j] + sx[j] * x + sy[j] * y;
+			double t = t0[j] + tx[j] * x + ty[j] * y;
+			inside |= (s > 0) & (t > 0) & ((s + t) < limit[j]);
+		}
+
+		if(inside)
+			return true;
+	}
+
+	return false;
+}
+
+void TriangleSet::clear()
+{
+	s0.clear();
+	sx.clear();
+	sy.clear();
+	t0.clear();
+	tx.clear();
+	ty.clear();
+	limit.clear();
+
+	minX = minY = numeric_limits<double>::infinity();
+	maxX = maxY = -numeric_limits<double>::infinity();
+}
+
+}
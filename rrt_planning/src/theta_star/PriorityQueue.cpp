@@ -22,6 +22,7 @@
  */
 
 #include "rrt_planning/theta_star/PriorityQueue.h"
+#include "rrt_planning/utils/Stats.h"
 
 #include <cassert>
 
@@ -30,6 +31,8 @@ namespace rrt_planning
 
 void PriorityQueue::insert(const Cell& cell, double cost)
 {
+    Stats::count(Stats::OPEN_INSERT);
+
     FrontierNode *frontierNode = new FrontierNode(cell, cost);
     auto res = open.insert(frontierNode);
     openMap[cell] = frontierNode;
@@ -64,6 +67,8 @@ bool PriorityQueue::empty() const
 
 Cell PriorityQueue::pop()
 {
+    Stats::count(Stats::OPEN_POP);
+
     auto it = open.begin();
     auto ptr = *it;
 
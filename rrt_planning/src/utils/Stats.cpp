@@ -0,0 +1,130 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/utils/Stats.h"
+
+namespace rrt_planning
+{
+
+void Stats::reset()
+{
+    for(int i = 0; i < COUNTERS; i++)
+        counters[i] = 0;
+
+    for(int i = 0; i < TIMERS; i++)
+        times[i] = 0;
+}
+
+Stats& Stats::operator+=(const Stats& other)
+{
+    for(int i = 0; i < COUNTERS; i++)
+        counters[i] += other.counters[i];
+
+    for(int i = 0; i < TIMERS; i++)
+        times[i] += other.times[i];
+
+    return *this;
+}
+
+void Stats::print(std::ostream& os) const
+{
+    for(int i = 0; i < COUNTERS; i++)
+        os << getName(static_cast<Counter>(i)) << " " << counters[i] << "\n";
+
+    for(int i = 0; i < TIMERS; i++)
+        os << getName(static_cast<Timer>(i)) << " " << times[i] << "\n";
+}
+
+const char* Stats::getName(Counter counter)
+{
+    switch(counter)
+    {
+    case MAP_IS_FREE:
+        return "map_is_free";
+    case MAP_BATCH_POINTS:
+        return "map_batch_points";
+    case MAP_RAY_STEPS:
+        return "map_ray_steps";
+    case MAP_CORRIDOR:
+        return "map_corridor";
+    case SG_COLLISION:
+        return "sg_collision";
+    case SG_CORNER:
+        return "sg_corner";
+    case SG_CACHE_HIT:
+        return "sg_cache_hit";
+    case SG_CACHE_MISS:
+        return "sg_cache_miss";
+    case EXTENDER_COMPUTE:
+        return "extender_compute";
+    case EXTENDER_LOS:
+        return "extender_los";
+    case EXTENDER_STEER:
+        return "extender_steer";
+    case INDEX_INSERT:
+        return "index_insert";
+    case INDEX_NEAREST:
+        return "index_nearest";
+    case OPEN_INSERT:
+        return "open_insert";
+    case OPEN_POP:
+        return "open_pop";
+    default:
+        return "unknown";
+    }
+}
+
+const char* Stats::getName(Timer timer)
+{
+    switch(timer)
+    {
+    case MAP_UPDATE_TIME:
+        return "map_update_time";
+    case SG_COLLISION_TIME:
+        return "sg_collision_time";
+    case SG_GEOMETRY_TIME:
+        return "sg_geometry_time";
+    case EXTENDER_TIME:
+        return "extender_time";
+    case INDEX_NEAREST_TIME:
+        return "index_nearest_time";
+    default:
+        return "unknown";
+    }
+}
+
+StatsScope::StatsScope(Stats& target) : target(target)
+{
+    outer = Stats::local();
+    Stats::local().reset();
+}
+
+StatsScope::~StatsScope()
+{
+    target = Stats::local();
+
+    Stats::local() = outer;
+    Stats::local() += target;
+}
+
+}
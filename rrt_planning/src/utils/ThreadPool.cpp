@@ -0,0 +1,189 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rrt_planning/utils/ThreadPool.h"
+
+#include <algorithm>
+
+namespace rrt_planning
+{
+
+ThreadPool::ThreadPool(int threads) : body(nullptr), pending(0), round(0), stop(false)
+{
+    threads = std::max(threads, 1);
+
+    for(int i = 0; i < threads; i++)
+        queues.emplace_back(new Queue());
+
+    workerStats.resize(threads);
+    for(Stats& stats : workerStats)
+        stats.reset();
+
+    for(int i = 1; i < threads; i++)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake.notify_all();
+
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int, int)>& body)
+{
+    if(n <= 0)
+        return;
+
+    if(workers.empty() || n == 1)
+    {
+        for(int i = 0; i < n; i++)
+            body(i, 0);
+
+        return;
+    }
+
+    this->body = &body;
+    pending = n;
+
+    //Contiguous chunks, so each worker starts on its own part of the range
+    int threads = queues.size();
+    for(int w = 0; w < threads; w++)
+    {
+        std::lock_guard<std::mutex> lock(queues[w]->mutex);
+        for(int i = w * n / threads; i < (w + 1) * n / threads; i++)
+            queues[w]->tasks.push_back(i);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        round++;
+    }
+
+    wake.notify_all();
+
+    while(runOne(0))
+    {
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]{ return pending == 0; });
+    }
+
+    this->body = nullptr;
+
+    for(int w = 1; w < threads; w++)
+    {
+        Stats::local() += workerStats[w];
+        workerStats[w].reset();
+    }
+}
+
+void ThreadPool::work(int worker)
+{
+    unsigned seen = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]{ return stop || round != seen; });
+
+            if(stop)
+                return;
+
+            seen = round;
+        }
+
+        while(runOne(worker));
+    }
+}
+
+bool ThreadPool::runOne(int worker)
+{
+    int task;
+    if(!take(worker, task))
+        return false;
+
+    if(worker == 0)
+    {
+        (*body)(task, worker);
+    }
+    else
+    {
+        Stats stats;
+        {
+            StatsScope scope(stats);
+            (*body)(task, worker);
+        }
+
+        workerStats[worker] += stats;
+    }
+
+    if(--pending == 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_one();
+    }
+
+    return true;
+}
+
+bool ThreadPool::take(int worker, int& task)
+{
+    //Own tasks from the front, stolen ones from the back
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty())
+        {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    int threads = queues.size();
+    for(int i = 1; i < threads; i++)
+    {
+        Queue& other = *queues[(worker + i) % threads];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if(!other.tasks.empty())
+        {
+            task = other.tasks.back();
+            other.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
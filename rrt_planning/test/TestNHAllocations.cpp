@@ -0,0 +1,178 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "rrt_planning/NHPlanner.h"
+#include "rrt_planning/map/Map.h"
+#include "rrt_planning/utils/Stats.h"
+
+using namespace rrt_planning;
+
+static bool counting = false;
+static long allocations = 0;
+
+//Steering and the collision checks of the map build their results, they are not counted
+static bool excluded()
+{
+	return Stats::isTiming(Stats::EXTENDER_TIME) || Stats::isTiming(Stats::SG_COLLISION_TIME) ||
+		   Stats::isTiming(Stats::SG_GEOMETRY_TIME);
+}
+
+void* operator new(std::size_t size)
+{
+	if(counting && !excluded())
+		allocations++;
+
+	void* p = std::malloc(size);
+	if(!p)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept
+{
+	std::free(p);
+}
+
+/*
+ * 20x20 world with two walls, the first one open at the top and the second
+ * one at the bottom, so that the search has to go around both.
+ */
+class WallsMap : public Map
+{
+public:
+	WallsMap()
+	{
+		bounds.minX = 0;
+		bounds.maxX = 20;
+		bounds.minY = 0;
+		bounds.maxY = 20;
+		bounds.minZ = 0;
+		bounds.maxZ = 0;
+	}
+
+	virtual bool isFree(const Eigen::VectorXd& p) override
+	{
+		Stats::count(Stats::MAP_IS_FREE);
+
+		if(!insideBound(p))
+			return false;
+
+		bool first = p(0) >= 7 && p(0) <= 8 && p(1) <= 13;
+		bool second = p(0) >= 12 && p(0) <= 13 && p(1) >= 7;
+
+		return !first && !second;
+	}
+
+	virtual bool isVoronoiFree(const Eigen::VectorXd& p) override
+	{
+		return isFree(p);
+	}
+
+	virtual unsigned char getCost(const Eigen::VectorXd& p) override
+	{
+		return isFree(p) ? 0 : 254;
+	}
+
+	virtual bool insideBound(const Eigen::VectorXd& p) override
+	{
+		return p(0) >= bounds.minX && p(0) <= bounds.maxX && p(1) >= bounds.minY && p(1) <= bounds.maxY;
+	}
+
+	virtual Eigen::VectorXd getOutsidePoint() override
+	{
+		Eigen::Vector3d p(bounds.maxX + 1.0, bounds.maxY + 1.0, 0);
+		return p;
+	}
+};
+
+static geometry_msgs::PoseStamped pose(double x, double y, double theta)
+{
+	geometry_msgs::PoseStamped msg;
+	msg.header.frame_id = "map";
+	msg.pose.position.x = x;
+	msg.pose.position.y = y;
+	msg.pose.orientation.z = std::sin(theta / 2);
+	msg.pose.orientation.w = std::cos(theta / 2);
+
+	return msg;
+}
+
+/*
+ * The same query run twice on the NH planner. Once the buffers have grown
+ * in the first query, the search of the second one must not allocate
+ * outside of steering and collision checking.
+ */
+int main(int argc, char *argv[])
+{
+	ros::init(argc, argv, "test_nh_allocations");
+	ros::NodeHandle nh("~");
+
+	//Deterministic samples, so that both queries expand the same states
+	nh.setParam("position_sampler", "Fixed");
+	nh.setParam("angle_sampler", "Fixed");
+	nh.setParam("motion_primitives/minU", std::vector<double>({0, -M_PI / 4}));
+	nh.setParam("motion_primitives/maxU", std::vector<double>({1, M_PI / 4}));
+	nh.setParam("motion_primitives/discretization", 20);
+
+	//The excluded calls are told apart by their running timers
+	Stats::setTiming(true);
+
+	WallsMap map;
+	NHPlanner planner("", map, std::chrono::duration<double>(60));
+
+	geometry_msgs::PoseStamped start = pose(2, 2, 0);
+	geometry_msgs::PoseStamped goal = pose(18, 18, M_PI / 2);
+	std::vector<geometry_msgs::PoseStamped> plan;
+
+	bool found[2];
+	long count[2];
+	for(int i = 0; i < 2; i++)
+	{
+		long before = allocations;
+		counting = true;
+		found[i] = planner.makePlan(start, goal, plan);
+		counting = false;
+		count[i] = allocations - before;
+
+		const Stats& stats = planner.getStats();
+		std::cout << "Query " << i + 1 << ": " << (found[i] ? "plan found" : "no plan") << ", "
+				  << stats.getCounter(Stats::OPEN_POP) << " expansions, "
+				  << count[i] << " allocations" << std::endl;
+	}
+
+	return (found[0] && found[1] && count[1] == 0) ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "rrt_planning/distance/Distance.h"
+#include "rrt_planning/extenders/MotionPrimitivesExtender.h"
+#include "rrt_planning/kinematics_models/DifferentialDrive.h"
+#include "rrt_planning/kinematics_models/controllers/ConstantController.h"
+#include "rrt_planning/map/SnapshotMap.h"
+
+using namespace rrt_planning;
+
+/*
+ * The cached swept cells of a long bending primitive against a fine sweep
+ * of the same motion, from starts anywhere inside a cell and headings
+ * anywhere inside a bucket. The cached check may reject free motions, but
+ * it must never accept a motion that the fine sweep finds in collision.
+ */
+int main(int argc, char *argv[])
+{
+	ros::init(argc, argv, "test_swept_cells");
+	ros::NodeHandle nh("~");
+
+	const double deltaT = 3;
+	const int buckets = 72;
+
+	//Two copies of the same primitive, so that the extender always picks the first one
+	nh.setParam("deltaT", deltaT);
+	nh.setParam("motion_primitives/swept", true);
+	nh.setParam("motion_primitives/heading_buckets", buckets);
+	nh.setParam("motion_primitives/minU", std::vector<double>({1, 0.5}));
+	nh.setParam("motion_primitives/maxU", std::vector<double>({1, 0.5}));
+	nh.setParam("motion_primitives/discretization", 2);
+
+	//Sparse random obstacle cells on a 8x8 m map
+	const int size = 160;
+	const double resolution = 0.05;
+	std::mt19937 generator(1);
+	std::vector<unsigned char> costs(size * size, 0);
+	for(auto& cost : costs)
+		cost = (generator() % 1000 < 3) ? 254 : 0;
+
+	SnapshotMap map(size, size, resolution, 0, 0, costs.data());
+
+	Eigen::VectorXd u(2);
+	u << 1, 0.5;
+	ConstantController controller;
+	DifferentialDrive model(controller);
+	L2ThetaDistance distance;
+	MotionPrimitivesExtender extender(model, controller, map, distance);
+	extender.initialize(nh);
+	controller.setControl(u);
+
+	//Fine sweep of the primitive from the origin, moved to each start below
+	const int steps = 1000;
+	Eigen::Matrix2Xd sweep(2, steps + 1);
+	for(int k = 0; k <= steps; k++)
+		sweep.col(k) = model.compute(Eigen::Vector3d::Zero(), deltaT * k / steps).head<2>();
+
+	std::uniform_real_distribution<double> position(3, 5);
+	std::uniform_real_distribution<double> inside(-0.5, 0.5);
+	int colliding = 0;
+	int accepted = 0;
+
+	for(int i = 0; i < 100000; i++)
+	{
+		Eigen::VectorXd x0(3);
+		x0 << position(generator), position(generator), 0;
+		x0(2) = (generator() % buckets + inside(generator)) * 2 * M_PI / buckets;
+
+		Eigen::Rotation2Dd rotation(x0(2));
+		bool collision = false;
+		for(int k = 0; k <= steps && !collision; k++)
+		{
+			Eigen::VectorXd p = x0;
+			p.head<2>() += rotation * sweep.col(k);
+			collision = !map.isFree(p);
+		}
+
+		Eigen::VectorXd xNew;
+		bool free = extender.los(x0, model.compute(x0, deltaT), xNew);
+
+		colliding += collision;
+		accepted += collision && free;
+	}
+
+	std::cout << colliding << " colliding motions, " << accepted << " accepted by the swept cells" << std::endl;
+
+	return (accepted == 0) ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/*
+ * rrt_planning,
+ *
+ *
+ * Copyright (C) 2016 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of rrt_planning.
+ *
+ * rrt_planning is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rrt_planning is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with rrt_planning.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "rrt_planning/map/SnapshotMap.h"
+
+using namespace rrt_planning;
+
+/*
+ * Map::isSweptFree on random segments of a map with random boxes, against
+ * a fine sampling of each segment. A segment accepted by the swept disc
+ * check must be free, and most of the free ones should be accepted.
+ */
+int main(int argc, char *argv[])
+{
+	const int size = 200;
+	const double resolution = 0.05;
+	std::mt19937 generator(1);
+
+	std::vector<unsigned char> costs(size * size, 0);
+	for(int k = 0; k < 30; k++)
+	{
+		int x0 = generator() % size;
+		int y0 = generator() % size;
+		int width = generator() % 20 + 1;
+		int height = generator() % 20 + 1;
+
+		for(int x = x0; x < std::min(x0 + width, size); x++)
+			for(int y = y0; y < std::min(y0 + height, size); y++)
+				costs[y * size + x] = 254;
+	}
+
+	SnapshotMap map(size, size, resolution, 0, 0, costs.data());
+	map.enableClearance();
+
+	std::uniform_real_distribution<double> position(0, size * resolution);
+	std::uniform_real_distribution<double> offset(-1, 1);
+	int free = 0;
+	int accepted = 0;
+	int wrong = 0;
+
+	for(int i = 0; i < 20000; i++)
+	{
+		Eigen::VectorXd a(2);
+		Eigen::VectorXd b(2);
+		a << position(generator), position(generator);
+		b << a(0) + offset(generator), a(1) + offset(generator);
+
+		bool sampledFree = true;
+		int steps = std::ceil((b - a).norm() / (resolution / 20));
+		for(int k = 0; k <= steps && sampledFree; k++)
+		{
+			Eigen::VectorXd p = a + (b - a) * k / std::max(steps, 1);
+			sampledFree = map.isFree(p);
+		}
+
+		bool swept = map.isSweptFree(a, b);
+
+		free += sampledFree;
+		accepted += swept;
+		wrong += swept && !sampledFree;
+	}
+
+	std::cout << free << " free segments, " << accepted << " accepted, " << wrong << " accepted in collision" << std::endl;
+
+	return (wrong == 0 && accepted > free / 2) ? 0 : 1;
+}
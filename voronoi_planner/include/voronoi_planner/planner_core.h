@@ -121,15 +121,11 @@ class VoronoiPlanner : public nav_core::BaseGlobalPlanner {
     private:
         void mapToWorld(double mx, double my, double& wx, double& wy);
         bool worldToMap(double wx, double wy, double& mx, double& my);
-        void clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my);
 
         double planner_window_x_, planner_window_y_, default_tolerance_;
         std::string tf_prefix_;
-        boost::mutex mutex_;
         ros::ServiceServer make_plan_srv_;
 
-        DynamicVoronoi voronoi_;
-
         void outlineMap(unsigned char* costarr, int nx, int ny, unsigned char value);
         unsigned char* cost_array_;
         unsigned int start_x_, start_y_, end_x_, end_y_;
@@ -143,17 +143,6 @@ void VoronoiPlanner::reconfigureCB(voronoi_planner::VoronoiPlannerConfig& config
     smooth_path_ = config.smooth_path;
 }
 
-void VoronoiPlanner::clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my) {
-    if (!initialized_) {
-        ROS_ERROR(
-                "This planner has not been initialized yet, but it is being used, please call initialize() before use");
-        return;
-    }
-
-    //set the associated costs in the cost map to be free
-    costmap_->setCost(mx, my, costmap_2d::FREE_SPACE);
-}
-
 bool VoronoiPlanner::makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp) {
     makePlan(req.start, req.goal, resp.plan.poses);
 
@@ -193,7 +182,6 @@ bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geo
 
 bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
                            double tolerance, std::vector<geometry_msgs::PoseStamped>& plan) {
-    boost::mutex::scoped_lock lock(mutex_);
     if (!initialized_) {
         ROS_ERROR(
                 "This planner has not been initialized yet, but it is being used, please call initialize() before use");
@@ -244,45 +232,40 @@ bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geo
     worldToMap(wx, wy, goal_x, goal_y);
 
 
-    //clear the starting cell within the costmap because we know it can't be an obstacle
-    tf::Stamped<tf::Pose> start_pose;
-    tf::poseStampedMsgToTF(start, start_pose);
-    clearRobotCell(start_pose, start_x_i, start_y_i);
-
-    int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
-
-    //outlineMap(costmap_->getCharMap(), nx, ny, costmap_2d::LETHAL_OBSTACLE);
-
-
     bool **map=NULL;
     int sizeX, sizeY;
 
-    sizeX = costmap_->getSizeInCellsX();
-    sizeY = costmap_->getSizeInCellsY();
-
-
-    map = new bool*[sizeX];
-
-//    ROS_INFO("Map size is %d %d", sizeX, sizeY);
-
     ros::Time t = ros::Time::now();
     ros::Time t_b = ros::Time::now();
 
+    //copy the costmap under its lock, the rest of the query works on the copy
+    {
+        boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
 
-    for (int x=0; x<sizeX; x++) {
-        (map)[x] = new bool[sizeY];
-    }
+        sizeX = costmap_->getSizeInCellsX();
+        sizeY = costmap_->getSizeInCellsY();
+
+        map = new bool*[sizeX];
 
-    for (int y=sizeY-1; y>=0; y--) {
         for (int x=0; x<sizeX; x++) {
-            unsigned char c = costmap_->getCost(x,y);
+            (map)[x] = new bool[sizeY];
+        }
 
-            if ( c == costmap_2d::FREE_SPACE || c == costmap_2d::NO_INFORMATION )
-                (map)[x][y] = false; // cell is free
-            else (map)[x][y] = true;// cell is occupied
+        for (int y=sizeY-1; y>=0; y--) {
+            for (int x=0; x<sizeX; x++) {
+                unsigned char c = costmap_->getCost(x,y);
+
+                if ( c == costmap_2d::FREE_SPACE || c == costmap_2d::NO_INFORMATION )
+                    (map)[x][y] = false; // cell is free
+                else (map)[x][y] = true;// cell is occupied
+            }
         }
     }
 
+    //clear the starting cell within the copy because we know it can't be an obstacle
+    if ((int)start_x_i < sizeX && (int)start_y_i < sizeY)
+        map[start_x_i][start_y_i] = false;
+
     //ROS_INFO("Time (for map convert): %f sec", (ros::Time::now() - t).toSec());
     t = ros::Time::now();
 
@@ -290,31 +273,33 @@ bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geo
     bool doPrune = true;
 
 
-    // initialize voronoi object it with the map
+    // initialize voronoi object it with the map, it owns the map from now on
+    // and it is local to the query, so concurrent queries do not share it
+    DynamicVoronoi voronoi;
 
     //ROS_INFO("voronoi.initializeMap");
-    voronoi_.initializeMap(sizeX, sizeY, map);
+    voronoi.initializeMap(sizeX, sizeY, map);
     ROS_FATAL("Time (for initializeMap): %f sec", (ros::Time::now() - t).toSec());
     t = ros::Time::now();
 
 
 
     //ROS_INFO("voronoi.update");
-    voronoi_.update(); // update distance map and Voronoi diagram
+    voronoi.update(); // update distance map and Voronoi diagram
     ROS_FATAL("Time (for update): %f sec", (ros::Time::now() - t).toSec());
     t = ros::Time::now();
 
 
 
     //ROS_INFO("voronoi.prune");
-    if (doPrune) voronoi_.prune();  // prune the Voronoi
+    if (doPrune) voronoi.prune();  // prune the Voronoi
     ROS_FATAL("Time (for prune): %f sec", (ros::Time::now() - t).toSec());
     t = ros::Time::now();
 
 
 
 //    ROS_INFO("voronoi.visualize");
-//    voronoi_.visualize("/tmp/initial.ppm");
+//    voronoi.visualize("/tmp/initial.ppm");
 //    ROS_INFO("Time (for visualize): %f sec", (ros::Time::now() - t).toSec());
 
 
@@ -339,33 +324,33 @@ bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geo
 
    bool res1 = false, res2 = false, res3 = false;
 
-    if( !voronoi_.isVoronoi(goal_x,goal_y) )
+    if( !voronoi.isVoronoi(goal_x,goal_y) )
     {
         //        path3 = findPath( goal, init, A, 0, 1 );
-        res3 = findPath( &path3, goal_x, goal_y, start_x, start_y, &voronoi_, 0, 1 );
+        res3 = findPath( &path3, goal_x, goal_y, start_x, start_y, &voronoi, 0, 1 );
         //std::cout << "findPath 3 res " << res3 << std::endl;
         //        goal = path3(end,:);
         goal_x = std::get<0>( path3[path3.size()-1] );
         goal_y = std::get<1>( path3[path3.size()-1] );
 
-        //std::cout << "voronoi.isVoronoi(goal_x,goal_y) " << voronoi_.isVoronoi(goal_x,goal_y) << std::endl;
+        //std::cout << "voronoi.isVoronoi(goal_x,goal_y) " << voronoi.isVoronoi(goal_x,goal_y) << std::endl;
 
 
         //        path3 = flipud(path3);
         std::reverse(path3.begin(), path3.end());
     } else {res3 = true;}
 
-    if( !voronoi_.isVoronoi(start_x,start_y) )
+    if( !voronoi.isVoronoi(start_x,start_y) )
     {
-        res1 = findPath( &path1, start_x, start_y, goal_x, goal_y, &voronoi_, 0, 1 );
+        res1 = findPath( &path1, start_x, start_y, goal_x, goal_y, &voronoi, 0, 1 );
         //std::cout << "findPath 1 res " << res1 << std::endl;
         start_x = std::get<0>( path1[path1.size()-1] );
         start_y = std::get<1>( path1[path1.size()-1] );
 
-        //std::cout << "voronoi.isVoronoi(start_x,start_y) " << voronoi_.isVoronoi(start_x,start_y) << std::endl;
+        //std::cout << "voronoi.isVoronoi(start_x,start_y) " << voronoi.isVoronoi(start_x,start_y) << std::endl;
     } else {res1 = true;}
 
-    res2 = findPath( &path2, start_x, start_y, goal_x, goal_y, &voronoi_, 1, 0 );
+    res2 = findPath( &path2, start_x, start_y, goal_x, goal_y, &voronoi, 1, 0 );
     //std::cout << "findPath 2 res " << res2 << std::endl;
 
 
@@ -399,7 +384,7 @@ bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geo
 //        smoothPath(&path1);
 //    }
 
-//    visualize("/tmp/plan.ppm", &voronoi_, map, &path1);
+//    visualize("/tmp/plan.ppm", &voronoi, map, &path1);
 
     smoothPath(&path1);
     for(int i = 0; i < path1.size(); i++)
@@ -438,7 +423,7 @@ bool VoronoiPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geo
     publishPlan(plan);
 
     if(publish_voronoi_grid_){
-        publishVoronoiGrid(&voronoi_);
+        publishVoronoiGrid(&voronoi);
     }
 
 //    delete potential_array_;